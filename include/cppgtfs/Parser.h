@@ -6,31 +6,50 @@
 #define AD_CPPGTFS_PARSER_H_
 
 #include <stdint.h>
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <exception>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <istream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include <cppgtfs/util/CsvIndex.h>
 #include <cppgtfs/util/CsvParser.h>
+#include <cppgtfs/util/ZipArchive.h>
 #include <cppgtfs/gtfs/Feed.h>
+#include <cppgtfs/gtfs/StopTimeColumns.h>
 #include <cppgtfs/gtfs/flat/Agency.h>
 #include <cppgtfs/gtfs/flat/Frequency.h>
 #include <cppgtfs/gtfs/flat/Route.h>
 #include <cppgtfs/gtfs/flat/Service.h>
 #include <cppgtfs/gtfs/flat/Shape.h>
 #include <cppgtfs/gtfs/flat/Transfer.h>
+#include <cppgtfs/gtfs/flat/Visitor.h>
 
 using std::string;
+using ad::util::CsvIndex;
 using ad::util::CsvParser;
 using ad::util::CsvParserException;
+using ad::util::ZipArchive;
+using ad::util::ZipException;
 using ad::cppgtfs::gtfs::Agency;
 using ad::cppgtfs::gtfs::Transfer;
 using ad::cppgtfs::gtfs::Shape;
 using ad::cppgtfs::gtfs::ShapePoint;
+using ad::cppgtfs::gtfs::ShapePoints;
 using ad::cppgtfs::gtfs::Service;
 using ad::cppgtfs::gtfs::ServiceDate;
 using ad::cppgtfs::gtfs::TripB;
@@ -71,6 +90,7 @@ class ParserException : public std::exception {
   virtual uint64_t getLine() const throw() { return _line; }
 
   void setFileName(const std::string& fn) { _file_name = fn; }
+  void setLine(int64_t line) { _line = line; }
 
  private:
   mutable std::string _what_msg;
@@ -80,20 +100,148 @@ class ParserException : public std::exception {
   std::string _file_name;
 };
 
+// Stop times parsed from a byte range of stop_times.txt in parallel mode.
+template <typename TripT, typename StopTimeT>
+struct StopTimeChunk {
+  // records starting in [begin, stop) belong to this chunk
+  const char* begin;
+  const char* stop;
+
+  // end of the last record of the chunk, set after parsing
+  const char* end;
+
+  std::vector<std::pair<TripT*, StopTimeT>> stopTimes;
+
+  // the first error in this chunk, stopTimes holds all rows before it
+  std::exception_ptr err;
+};
+
+// References resolved while reading stop_times.txt. Consecutive records
+// nearly always belong to the same trip, and consecutive trips often serve
+// the same stops, so the trip is only looked up once per run of records
+// with the same trip_id, and the k-th stop of a run is first compared to
+// the k-th stop of the previous run before it is looked up.
+template <typename TripT, typename StopT>
+struct StopTimeRefs {
+  // what the stop times of TripT hold to refer to their stop
+  typedef typename TripT::StopTimes::value_type::StopRef StopRef;
+
+  std::string tripId;
+  TripT* trip = 0;
+
+  // the stops of the current and of the previous run, with their StopRef
+  std::vector<std::pair<StopT*, StopRef>> stops;
+  std::vector<std::pair<StopT*, StopRef>> prevStops;
+
+  // the trip_id of the last record checked against the filter, and whether
+  // that trip was dropped
+  std::string filterTripId;
+  bool tripSkipped = false;
+};
+
+// A memory-mapped table of a lazily loaded feed. It is kept open after
+// parsing, so that the records of single trips or shapes can be read on
+// demand.
+template <typename FldsT>
+struct LazyTable {
+  // owns the mapping, and holds the header
+  std::unique_ptr<CsvParser> csvp;
+  FldsT flds;
+  std::string file;
+
+  // the mapped file, the offsets in a CsvIndex are relative to base
+  const char* base;
+  const char* end;
+};
+
+// Restricts parsing to a part of a feed. Entities outside of the filter are
+// dropped while parsing, together with everything that references them.
+struct ParserFilter {
+  // only services active on some day in [from, to]. An empty date leaves
+  // the window open on that side
+  gtfs::ServiceDate from, to;
+
+  // if not empty, only the agencies and routes with these ids
+  std::unordered_set<std::string> agencies;
+  std::unordered_set<std::string> routes;
+
+  // only stops inside this box
+  double minLat = -90, minLng = -180, maxLat = 90, maxLng = 180;
+};
+
 class Parser {
  public:
   // Default initialization.
-  Parser() : _strict(false) {}
-  Parser(bool strict) : _strict(strict) {}
-
-  // parse a zip/folder into a GtfsFeed
+  Parser()
+      : _strict(false), _numThreads(1), _lazy(false), _indexCache(false) {}
+  Parser(bool strict)
+      : _strict(strict), _numThreads(1), _lazy(false), _indexCache(false) {}
+
+  // If numThreads > 1, up to numThreads independent tables are parsed
+  // concurrently (the calling thread included), and stop_times.txt is
+  // parsed in parallel by up to numThreads threads of its own. The result
+  // (including errors) is the same as in serial mode.
+  Parser(bool strict, size_t numThreads)
+      : _strict(strict),
+        _numThreads(numThreads),
+        _lazy(false),
+        _indexCache(false) {}
+
+  // Only the part of the feed selected by filter is parsed.
+  Parser(bool strict, size_t numThreads, const ParserFilter& filter)
+      : _strict(strict),
+        _numThreads(numThreads),
+        _filter(filter),
+        _lazy(false),
+        _indexCache(false) {}
+
+  // In lazy mode, shapes.txt and stop_times.txt are only indexed while
+  // parsing. The points of a shape and the stop times of a trip are read
+  // from the table on the first access to them, which also reports their
+  // errors. The tables stay mapped as long as the feed exists. Only applies
+  // to feed folders, tables in ZIP archives are always read completely.
+  // Shape points do not contribute to the feed's bounding box in lazy mode.
+  void setLazy(bool lazy) { _lazy = lazy; }
+
+  // In lazy mode, keep the index of each lazily read table in a sidecar
+  // file next to it (for example, stop_times.txt.idx), and reuse it in later
+  // parses as long as the table has not changed. Sidecars which cannot be
+  // written are silently skipped.
+  void setIndexCache(bool cache) { _indexCache = cache; }
+
+  // parse a zip/folder into a GtfsFeed. ZIP archives are read directly,
+  // without extracting them.
   FEEDTPL
   bool parse(gtfs::FEEDB* targetFeed, const std::string& path) const;
 
+  // Like parse(), but appends the stop times to cols instead of to their
+  // trips, which are left without stop times. Apart from those of the trip
+  // being read, the stop times are only held in the columns. stop_times.txt
+  // is read serially and completely, also in lazy mode.
+  FEEDTPL
+  bool parse(gtfs::FEEDB* targetFeed, const std::string& path,
+             gtfs::StopTimeColumns<
+                 TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>, StopT>*
+                 cols) const;
+
+  // Streams the records of the zip/folder at path through the callbacks of
+  // visitor, one record at a time and without building a feed. Tables are
+  // read in the same order as by parse(), tables without a callback are
+  // skipped. References between the tables are not checked.
+  inline void parse(const std::string& path,
+                    const gtfs::flat::Visitor& visitor) const;
+
   inline std::string getString(const CsvParser& csv, size_t field) const;
   inline std::string getString(const CsvParser& csv, size_t field,
                                const std::string& def) const;
 
+  // Like getString(), but the result is only valid until the next record is
+  // read. Assigning it to a reused string does not allocate.
+  inline std::string_view getStringView(const CsvParser& csv,
+                                        size_t field) const;
+  inline std::string_view getStringView(const CsvParser& csv, size_t field,
+                                        std::string_view def) const;
+
   inline double getDouble(const CsvParser& csv, size_t field) const;
   inline double getDouble(const CsvParser& csv, size_t fld, double def) const;
 
@@ -208,49 +356,255 @@ class Parser {
 
  private:
   bool _strict;
+  size_t _numThreads;
+  ParserFilter _filter;
+  bool _lazy;
+  bool _indexCache;
+
+  // A set of ids which can be looked up by a string_view without building
+  // a string first.
+  class IdSet {
+   public:
+    IdSet() {}
+    IdSet(const IdSet&) = delete;
+    IdSet& operator=(const IdSet&) = delete;
+
+    void insert(std::string_view id) {
+      if (_set.count(id)) return;
+      _ids.push_back(std::string(id));
+      _set.insert(_ids.back());
+    }
+    void erase(std::string_view id) { _set.erase(id); }
+    size_t count(std::string_view id) const { return _set.count(id); }
+    bool empty() const { return _set.empty(); }
+
+   private:
+    // the viewed ids, erased ones are kept until the set is destroyed
+    std::deque<std::string> _ids;
+    std::unordered_set<std::string_view> _set;
+  };
+
+  // ids of the entities dropped by the filter during a parse
+  struct Skipped {
+    IdSet agencies, stops, routes, services, trips, fares;
+  };
+
+  // The feed read by a single parse, and the state of this parse. A ZIP
+  // archive is opened once, and all of its tables are read from it.
+  struct ParseContext {
+    // Throws a ParserException if path is not a readable ZIP archive.
+    inline explicit ParseContext(const std::string& path);
+
+    std::string path;
+    std::unique_ptr<ZipArchive> zip;
+
+    // shared with the loaders of a lazily parsed feed
+    std::shared_ptr<Skipped> skipped;
+
+    // if set, reads the opened stop_times.txt instead of parseStopTimes()
+    std::function<void(CsvParser*)> readStopTimes;
+  };
+
+  // Parses the tables of the feed, serially or concurrently.
+  FEEDTPL
+  void parseTables(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  // Parses the tables of the feed on up to _numThreads threads, each one as
+  // soon as the tables it references are complete.
+  FEEDTPL
+  void parseConcurrently(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  static uint32_t atoi(const char** p, const char* end);
+
+  // Opens the table file of the feed, which is either a folder or a ZIP
+  // archive. The returned parser is not open if the file does not exist.
+  inline std::unique_ptr<CsvParser> openTable(const ParseContext& ctx,
+                                              const std::string& file) const;
+
+  // Streams the records of a table through cb. A missing table is an error
+  // if required is set.
+  template <typename FldsT, typename RecT>
+  void visitTable(const ParseContext& ctx, const std::string& file,
+                  bool required, FldsT (*getFlds)(CsvParser*),
+                  bool (Parser::*next)(CsvParser*, RecT*, const FldsT&) const,
+                  const std::function<void(const RecT&)>& cb) const;
+
+  FEEDTPL
+  void parseAgencies(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseStops(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseRoutes(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseTrips(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseStopTimes(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseCalendar(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseCalendarDates(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseFareAttributes(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseFareRules(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseShapes(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseFrequencies(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseTransfers(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseFeedInfo(gtfs::FEEDB* targetFeed, ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseAgencies(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                     ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseStops(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                  ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseRoutes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                   ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseTrips(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                  ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseStopTimes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                      ParseContext* ctx) const;
+
+  FEEDTPL
+  void parseCalendar(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                     ParseContext* ctx) const;
 
-  static uint32_t atoi(const char** p);
+  FEEDTPL
+  void parseCalendarDates(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                          ParseContext* ctx) const;
 
   FEEDTPL
-  void parseAgencies(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseFareAttributes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                           ParseContext* ctx) const;
 
   FEEDTPL
-  void parseStops(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseFareRules(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                      ParseContext* ctx) const;
 
   FEEDTPL
-  void parseRoutes(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseShapes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const;
 
   FEEDTPL
-  void parseTrips(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseFrequencies(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                        ParseContext* ctx) const;
 
   FEEDTPL
-  void parseStopTimes(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                      ParseContext* ctx) const;
 
   FEEDTPL
-  void parseCalendar(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseFeedInfo(gtfs::FEEDB* targetFeed, CsvParser* csvp) const;
+
+  // Lazy mode: returns the index of the remaining records of the table csvp
+  // read from file by the given field. Reads it from, or writes it to, the
+  // table's sidecar if the index cache is enabled.
+  inline CsvIndex indexTable(CsvParser* csvp, const std::string& field,
+                             const std::string& file) const;
+
+  // Lazy mode: calls f with each record in ranges of tbl, and reports its
+  // errors with the actual line and file.
+  template <typename FldsT, typename F>
+  void readRanges(const LazyTable<FldsT>& tbl,
+                  const CsvIndex::Ranges& ranges, F f) const;
 
   FEEDTPL
-  void parseCalendarDates(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void indexStopTimes(gtfs::FEEDB* targetFeed, std::unique_ptr<CsvParser> csvp,
+                      const std::string& file, ParseContext* ctx) const;
 
   FEEDTPL
-  void parseFareAttributes(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void loadStopTimes(gtfs::FEEDB* targetFeed,
+                     const LazyTable<gtfs::flat::StopTimeFlds>& tbl,
+                     const CsvIndex::Ranges& ranges,
+                     const std::string& tripId, const Skipped& skipped,
+                     std::vector<StopTimeT<StopT>>* sts) const;
 
   FEEDTPL
-  void parseFareRules(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void indexShapes(gtfs::FEEDB* targetFeed, std::unique_ptr<CsvParser> csvp,
+                   const std::string& file) const;
+
+  inline void loadShapePoints(const LazyTable<gtfs::flat::ShapeFlds>& tbl,
+                              const CsvIndex::Ranges& ranges,
+                              const std::string& shapeId,
+                              ShapePoints* pts) const;
+
+  // Fills c from the current record of csvp.
+  inline void readShapePoint(CsvParser* csvp, gtfs::flat::ShapePoint* c,
+                             const gtfs::flat::ShapeFlds& flds) const;
+
+  // Fills s from the current record of csvp.
+  inline void readStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
+                           const gtfs::flat::StopTimeFlds& flds) const;
+
+  // Returns true if the current record of csvp references a trip or stop
+  // dropped by the filter. Only the trip_id and stop_id fields are read.
+  template <typename TripT, typename StopT>
+  bool skipStopTime(const CsvParser& csvp,
+                    const gtfs::flat::StopTimeFlds& flds,
+                    const Skipped& skipped,
+                    StopTimeRefs<TripT, StopT>* refs) const;
 
   FEEDTPL
-  void parseShapes(gtfs::FEEDB* targetFeed, std::istream*) const;
+  StopTimeT<StopT> getStopTime(
+      gtfs::FEEDB* targetFeed, const gtfs::flat::StopTime& fst,
+      const CsvParser& csvp,
+      StopTimeRefs<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>, StopT>*
+          refs) const;
 
   FEEDTPL
-  void parseFrequencies(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseStopTimes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                      const char* begin, const char* end,
+                      const Skipped& skipped) const;
 
+  // Appends the stop times read from csvp to cols, one trip at a time.
   FEEDTPL
-  void parseTransfers(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseStopTimes(
+      gtfs::FEEDB* targetFeed, CsvParser* csvp, const Skipped& skipped,
+      gtfs::StopTimeColumns<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>,
+                            StopT>* cols) const;
+
+  // Appends st to the stop times of trip. Returns false if st has the same
+  // stop_sequence as the previous stop time of the trip. If st comes before
+  // it, the trip is added to unsorted.
+  template <typename TripT, typename StopTimeT>
+  static bool appendStopTime(TripT* trip, const StopTimeT& st,
+                             std::vector<TripT*>* unsorted);
+
+  // Sorts the stop times of the trips in unsorted, which may contain a trip
+  // more than once.
+  template <typename TripT>
+  static void sortStopTimes(const std::vector<TripT*>& unsorted);
 
   FEEDTPL
-  void parseFeedInfo(gtfs::FEEDB* targetFeed, std::istream*) const;
+  void parseStopTimesChunk(
+      gtfs::FEEDB* targetFeed, const CsvParser& hdr,
+      const gtfs::flat::StopTimeFlds& flds, const Skipped& skipped,
+      StopTimeChunk<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>,
+                    StopTimeT<StopT>>* chunk) const;
 };
-#include <cppgtfs/gtfs/Parser.tpp>
+#include <cppgtfs/Parser.tpp>
 }  // namespace cppgtfs
 }  // namespace ad
 
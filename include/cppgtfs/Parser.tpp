@@ -5,29 +5,256 @@
 // ____________________________________________________________________________
 FEEDTPL bool Parser::parse(gtfs::FEEDB* targetFeed,
                            const std::string& path) const {
-  std::ifstream fs;
   std::string gtfsPath(path);
-  std::string curFile;
 
   targetFeed->setPath(gtfsPath);
 
-  parseFeedInfo(targetFeed, path);
-  parseAgencies(targetFeed, path);
-  parseStops(targetFeed, path);
-  parseRoutes(targetFeed, path);
-  parseCalendar(targetFeed, path);
-  parseCalendarDates(targetFeed, path);
-  parseShapes(targetFeed, path);
-  parseTrips(targetFeed, path);
-  parseStopTimes(targetFeed, path);
-  parseFrequencies(targetFeed, path);
-  parseTransfers(targetFeed, path);
-  parseFareAttributes(targetFeed, path);
-  parseFareRules(targetFeed, path);
+  ParseContext ctx(path);
+  parseTables(targetFeed, &ctx);
 
   return true;
 }
 
+// ____________________________________________________________________________
+FEEDTPL bool Parser::parse(
+    gtfs::FEEDB* targetFeed, const std::string& path,
+    gtfs::StopTimeColumns<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>,
+                          StopT>* cols) const {
+  targetFeed->setPath(path);
+
+  ParseContext ctx(path);
+  ctx.readStopTimes = [&](CsvParser* csvp) {
+    parseStopTimes(targetFeed, csvp, *ctx.skipped, cols);
+  };
+  parseTables(targetFeed, &ctx);
+
+  return true;
+}
+
+// ____________________________________________________________________________
+FEEDTPL void Parser::parseTables(gtfs::FEEDB* targetFeed,
+                                 ParseContext* ctx) const {
+  if (_numThreads > 1) {
+    parseConcurrently(targetFeed, ctx);
+    return;
+  }
+
+  parseFeedInfo(targetFeed, ctx);
+  parseAgencies(targetFeed, ctx);
+  parseStops(targetFeed, ctx);
+  parseRoutes(targetFeed, ctx);
+  parseCalendar(targetFeed, ctx);
+  parseCalendarDates(targetFeed, ctx);
+  parseShapes(targetFeed, ctx);
+  parseTrips(targetFeed, ctx);
+  parseStopTimes(targetFeed, ctx);
+  parseFrequencies(targetFeed, ctx);
+  parseTransfers(targetFeed, ctx);
+  parseFareAttributes(targetFeed, ctx);
+  parseFareRules(targetFeed, ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL void Parser::parseConcurrently(gtfs::FEEDB* targetFeed,
+                                       ParseContext* ctx) const {
+  struct Step {
+    std::function<void()> f;
+    std::vector<size_t> deps;
+    bool started;
+    bool done;
+    std::exception_ptr err;
+  };
+
+  // the steps, in the order in which they are added below
+  enum {
+    FEED_INFO,
+    AGENCIES,
+    STOPS,
+    ROUTES,
+    CALENDAR,
+    CALENDAR_DATES,
+    SHAPES,
+    TRIPS,
+    STOP_TIMES,
+    FREQUENCIES,
+    TRANSFERS,
+    FARE_ATTRS,
+    FARE_RULES
+  };
+
+  // in serial order, which is a topological order of the dependencies
+  std::vector<Step> steps;
+  auto add = [&](std::vector<size_t> deps, std::function<void()> f) {
+    steps.push_back(Step{f, deps, false, false, std::exception_ptr()});
+  };
+
+  add({}, [&]() { parseFeedInfo(targetFeed, ctx); });
+  add({}, [&]() { parseAgencies(targetFeed, ctx); });
+  add({}, [&]() { parseStops(targetFeed, ctx); });
+  add({AGENCIES}, [&]() { parseRoutes(targetFeed, ctx); });
+  add({}, [&]() { parseCalendar(targetFeed, ctx); });
+  add({CALENDAR}, [&]() { parseCalendarDates(targetFeed, ctx); });
+  add({}, [&]() { parseShapes(targetFeed, ctx); });
+  add({ROUTES, CALENDAR_DATES, SHAPES}, [&]() { parseTrips(targetFeed, ctx); });
+  add({TRIPS, STOPS}, [&]() { parseStopTimes(targetFeed, ctx); });
+  add({TRIPS}, [&]() { parseFrequencies(targetFeed, ctx); });
+  add({STOPS}, [&]() { parseTransfers(targetFeed, ctx); });
+  add({AGENCIES}, [&]() { parseFareAttributes(targetFeed, ctx); });
+  add({FARE_ATTRS, ROUTES, STOPS}, [&]() { parseFareRules(targetFeed, ctx); });
+
+  std::mutex m;
+  std::condition_variable cv;
+
+  // runs the first step whose dependencies are done until all steps are
+  // done. If a dependency failed, the step fails with the same error
+  // without running
+  auto work = [&]() {
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+      Step* next = 0;
+      bool done = true;
+
+      for (auto& s : steps) {
+        done = done && s.done;
+        if (next || s.started) continue;
+
+        bool ready = true;
+        for (size_t d : s.deps) ready = ready && steps[d].done;
+        if (ready) next = &s;
+      }
+
+      if (done) return;
+
+      if (!next) {
+        cv.wait(lock);
+        continue;
+      }
+
+      next->started = true;
+
+      std::exception_ptr err;
+      for (size_t d : next->deps) {
+        if (!err) err = steps[d].err;
+      }
+
+      if (!err) {
+        lock.unlock();
+        try {
+          next->f();
+        } catch (...) {
+          err = std::current_exception();
+        }
+        lock.lock();
+      }
+
+      next->err = err;
+      next->done = true;
+      cv.notify_all();
+    }
+  };
+
+  // the calling thread is one of the workers
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(_numThreads, steps.size()); i++) {
+    workers.push_back(std::thread(work));
+  }
+  work();
+  for (auto& w : workers) w.join();
+
+  // report the error the serial mode would have reported: the first failed
+  // step in serial order failed on its own, as its dependencies come before
+  for (const auto& s : steps) {
+    if (s.err) std::rethrow_exception(s.err);
+  }
+}
+
+// ____________________________________________________________________________
+inline void Parser::parse(const std::string& path,
+                          const gtfs::flat::Visitor& visitor) const {
+  ParseContext ctx(path);
+
+  visitTable(ctx, "agency.txt", true, &Parser::getAgencyFlds,
+             &Parser::nextAgency, visitor.agency);
+  visitTable(ctx, "stops.txt", true, &Parser::getStopFlds, &Parser::nextStop,
+             visitor.stop);
+  visitTable(ctx, "routes.txt", true, &Parser::getRouteFlds,
+             &Parser::nextRoute, visitor.route);
+  visitTable(ctx, "calendar.txt", false, &Parser::getCalendarFlds,
+             &Parser::nextCalendar, visitor.calendar);
+  visitTable(ctx, "calendar_dates.txt", false, &Parser::getCalendarDateFlds,
+             &Parser::nextCalendarDate, visitor.calendarDate);
+  visitTable(ctx, "shapes.txt", false, &Parser::getShapeFlds,
+             &Parser::nextShapePoint, visitor.shapePoint);
+  visitTable(ctx, "trips.txt", true, &Parser::getTripFlds, &Parser::nextTrip,
+             visitor.trip);
+  visitTable(ctx, "stop_times.txt", true, &Parser::getStopTimeFlds,
+             &Parser::nextStopTime, visitor.stopTime);
+  visitTable(ctx, "frequencies.txt", false, &Parser::getFrequencyFlds,
+             &Parser::nextFrequency, visitor.frequency);
+  visitTable(ctx, "transfers.txt", false, &Parser::getTransfersFlds,
+             &Parser::nextTransfer, visitor.transfer);
+  visitTable(ctx, "fare_attributes.txt", false, &Parser::getFareFlds,
+             &Parser::nextFare, visitor.fare);
+  visitTable(ctx, "fare_rules.txt", false, &Parser::getFareRuleFlds,
+             &Parser::nextFareRule, visitor.fareRule);
+}
+
+// ____________________________________________________________________________
+template <typename FldsT, typename RecT>
+void Parser::visitTable(
+    const ParseContext& ctx, const std::string& file, bool required,
+    FldsT (*getFlds)(CsvParser*),
+    bool (Parser::*next)(CsvParser*, RecT*, const FldsT&) const,
+    const std::function<void(const RecT&)>& cb) const {
+  if (!cb) return;
+
+  std::string curFile = ctx.path + "/" + file;
+  try {
+    auto csvp = openTable(ctx, file);
+    if (!csvp->isOpen()) {
+      if (required) fileNotFound(curFile);
+      return;
+    }
+
+    RecT r;
+    auto flds = getFlds(csvp.get());
+    while ((this->*next)(csvp.get(), &r, flds)) cb(r);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
+  } catch (const CsvParserException& e) {
+    throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
+                          curFile.c_str());
+  } catch (const ParserException& e) {
+    // augment with file name
+    ParserException fe = e;
+    fe.setFileName(curFile.c_str());
+    throw fe;
+  }
+}
+
+// ____________________________________________________________________________
+inline Parser::ParseContext::ParseContext(const std::string& path)
+    : path(path), skipped(std::make_shared<Skipped>()) {
+  if (!ZipArchive::isZipFile(path)) return;
+
+  try {
+    zip.reset(new ZipArchive(path));
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, path.c_str());
+  }
+}
+
+// ____________________________________________________________________________
+inline std::unique_ptr<CsvParser> Parser::openTable(
+    const ParseContext& ctx, const std::string& file) const {
+  if (ctx.zip) {
+    std::unique_ptr<std::istream> s = ctx.zip->open(file);
+    return std::unique_ptr<CsvParser>(new CsvParser(std::move(s)));
+  }
+
+  return std::unique_ptr<CsvParser>(new CsvParser(ctx.path + "/" + file));
+}
+
 // ____________________________________________________________________________
 inline gtfs::flat::TransfersFlds Parser::getTransfersFlds(CsvParser* csvp) {
   gtfs::flat::TransfersFlds t;
@@ -42,8 +269,8 @@ inline gtfs::flat::TransfersFlds Parser::getTransfersFlds(CsvParser* csvp) {
 inline bool Parser::nextTransfer(CsvParser* csvp, gtfs::flat::Transfer* t,
                                  const gtfs::flat::TransfersFlds& flds) const {
   if (csvp->readNextLine()) {
-    t->fromStop = getString(*csvp, flds.fromStopIdFld);
-    t->toStop = getString(*csvp, flds.toStopIdFld);
+    t->fromStop = getStringView(*csvp, flds.fromStopIdFld);
+    t->toStop = getStringView(*csvp, flds.toStopIdFld);
     t->type = static_cast<gtfs::flat::Transfer::TYPE>(
         getRangeInteger(*csvp, flds.transferTypeFld, 0, 3, 0));
     t->tTime =
@@ -56,13 +283,17 @@ inline bool Parser::nextTransfer(CsvParser* csvp, gtfs::flat::Transfer* t,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseTransfers(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseTransfers(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                            ParseContext* ctx) const {
   gtfs::flat::Transfer ft;
-  auto flds = getTransfersFlds(&csvp);
+  auto flds = getTransfersFlds(csvp);
+
+  while (nextTransfer(csvp, &ft, flds)) {
+    if (ctx->skipped->stops.count(ft.fromStop) ||
+        ctx->skipped->stops.count(ft.toStop)) {
+      continue;
+    }
 
-  while (nextTransfer(&csvp, &ft, flds)) {
     StopT* fromStop = targetFeed->getStops().get(ft.fromStop);
     StopT* toStop = targetFeed->getStops().get(ft.toStop);
 
@@ -71,7 +302,7 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, std::istream* s) const {
       msg << "no stop with id '" << ft.fromStop
           << "' defined in stops.txt, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "from_stop_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "from_stop_id", csvp->getCurLine());
     }
 
     if (!toStop) {
@@ -79,7 +310,7 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed, std::istream* s) const {
       msg << "no stop with id '" << ft.toStop
           << "' defined in stops.txt, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "to_stop_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "to_stop_id", csvp->getCurLine());
     }
     Transfer t(fromStop, toStop, ft.type, ft.tTime);
     targetFeed->getTransfers().push_back(t);
@@ -101,7 +332,7 @@ inline gtfs::flat::FrequencyFlds Parser::getFrequencyFlds(CsvParser* csvp) {
 inline bool Parser::nextFrequency(CsvParser* csvp, gtfs::flat::Frequency* r,
                                   const gtfs::flat::FrequencyFlds& flds) const {
   if (csvp->readNextLine()) {
-    r->tripId = getString(*csvp, flds.tripIdFld);
+    r->tripId = getStringView(*csvp, flds.tripIdFld);
     r->startTime = getTime(*csvp, flds.startTimeFld);
     r->endTime = getTime(*csvp, flds.endTimeFld);
     r->headwaySecs = getRangeInteger(*csvp, flds.headwaySecsFld, 0, UINT16_MAX);
@@ -114,20 +345,21 @@ inline bool Parser::nextFrequency(CsvParser* csvp, gtfs::flat::Frequency* r,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseFrequencies(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseFrequencies(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                              ParseContext* ctx) const {
   gtfs::flat::Frequency ff;
-  auto flds = getFrequencyFlds(&csvp);
+  auto flds = getFrequencyFlds(csvp);
+
+  while (nextFrequency(csvp, &ff, flds)) {
+    if (ctx->skipped->trips.count(ff.tripId)) continue;
 
-  while (nextFrequency(&csvp, &ff, flds)) {
     gtfs::Frequency f(ff.startTime, ff.endTime, ff.headwaySecs, ff.exactTimes);
 
     auto trip = targetFeed->getTrips().get(ff.tripId);
     if (!trip) {
       std::stringstream msg;
       msg << "trip '" << ff.tripId << "' not found.";
-      throw ParserException(msg.str(), "trip_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "trip_id", csvp->getCurLine());
     }
 
     trip->addFrequency(f);
@@ -151,16 +383,17 @@ inline gtfs::flat::FareFlds Parser::getFareFlds(CsvParser* csvp) {
 inline bool Parser::nextFare(CsvParser* csvp, gtfs::flat::Fare* t,
                              const gtfs::flat::FareFlds& flds) const {
   if (csvp->readNextLine()) {
-    t->id = getString(*csvp, flds.fareIdFld);
+    t->id = getStringView(*csvp, flds.fareIdFld);
     t->price = getDouble(*csvp, flds.priceFld);
-    t->currencyType = getString(*csvp, flds.currencyTypeFld);
+    t->currencyType = getStringView(*csvp, flds.currencyTypeFld);
     t->paymentMethod = static_cast<typename gtfs::flat::Fare::PAYMENT_METHOD>(
         getRangeInteger(*csvp, flds.paymentMethodFld, 0, 1));
     t->numTransfers = static_cast<typename gtfs::flat::Fare::NUM_TRANSFERS>(
         getRangeInteger(*csvp, flds.transfersFld, 0, 3, 3));
-    t->agency = getString(*csvp, flds.agencyFld, "");
+    t->agency = getStringView(*csvp, flds.agencyFld, "");
     t->duration =
         getRangeInteger(*csvp, flds.transferDurationFld, 0, INT64_MAX, -1);
+    return true;
   }
 
   return false;
@@ -168,14 +401,17 @@ inline bool Parser::nextFare(CsvParser* csvp, gtfs::flat::Fare* t,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
-                                 std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                                 ParseContext* ctx) const {
   gtfs::flat::Fare ff;
-  auto flds = getFareFlds(&csvp);
+  auto flds = getFareFlds(csvp);
+
+  while (nextFare(csvp, &ff, flds)) {
+    if (ctx->skipped->agencies.count(ff.agency)) {
+      ctx->skipped->fares.insert(ff.id);
+      continue;
+    }
 
-  while (nextFare(&csvp, &ff, flds)) {
     typename AgencyT::Ref agency = typename AgencyT::Ref();
 
     if (!ff.agency.empty()) {
@@ -184,7 +420,7 @@ void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
         std::stringstream msg;
         msg << "no agency with id '" << ff.agency << "' defined, cannot "
             << "reference here.";
-        throw ParserException(msg.str(), "agency_id", csvp.getCurLine());
+        throw ParserException(msg.str(), "agency_id", csvp->getCurLine());
       }
     }
 
@@ -209,11 +445,12 @@ inline gtfs::flat::FareRuleFlds Parser::getFareRuleFlds(CsvParser* csvp) {
 inline bool Parser::nextFareRule(CsvParser* csvp, gtfs::flat::FareRule* t,
                                  const gtfs::flat::FareRuleFlds& flds) const {
   if (csvp->readNextLine()) {
-    t->fare = getString(*csvp, flds.fareIdFld);
-    t->route = getString(*csvp, flds.routeIdFld, "");
-    t->originZone = getString(*csvp, flds.originIdFld, "");
-    t->destZone = getString(*csvp, flds.destinationIdFld, "");
-    t->containsZone = getString(*csvp, flds.containsIdFld, "");
+    t->fare = getStringView(*csvp, flds.fareIdFld);
+    t->route = getStringView(*csvp, flds.routeIdFld, "");
+    t->originZone = getStringView(*csvp, flds.originIdFld, "");
+    t->destZone = getStringView(*csvp, flds.destinationIdFld, "");
+    t->containsZone = getStringView(*csvp, flds.containsIdFld, "");
+    return true;
   }
 
   return false;
@@ -221,13 +458,17 @@ inline bool Parser::nextFareRule(CsvParser* csvp, gtfs::flat::FareRule* t,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseFareRules(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                            ParseContext* ctx) const {
   gtfs::flat::FareRule fr;
-  auto flds = getFareRuleFlds(&csvp);
+  auto flds = getFareRuleFlds(csvp);
+
+  while (nextFareRule(csvp, &fr, flds)) {
+    if (ctx->skipped->fares.count(fr.fare) ||
+        ctx->skipped->routes.count(fr.route)) {
+      continue;
+    }
 
-  while (nextFareRule(&csvp, &fr, flds)) {
     Fare<RouteT>* fare = targetFeed->getFares().get(fr.fare);
     RouteT* route = targetFeed->getRoutes().get(fr.route);
 
@@ -235,14 +476,14 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
       std::stringstream msg;
       msg << "no fare with id '" << fr.fare << "' defined, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "fare_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "fare_id", csvp->getCurLine());
     }
 
     if (!fr.route.empty() && !route) {
       std::stringstream msg;
       msg << "no route with id '" << fr.route << "' defined, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "route_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "route_id", csvp->getCurLine());
     }
 
     if (!fr.originZone.empty() &&
@@ -251,7 +492,7 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
       msg << "no zone with id '" << fr.originZone
           << "' defined in stops.txt, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "origin_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "origin_id", csvp->getCurLine());
     }
 
     if (!fr.destZone.empty() && !targetFeed->getZones().count(fr.destZone)) {
@@ -259,7 +500,7 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
       msg << "no zone with id '" << fr.destZone
           << "' defined in stops.txt, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "destination_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "destination_id", csvp->getCurLine());
     }
 
     if (!fr.containsZone.empty() &&
@@ -268,7 +509,7 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
       msg << "no zone with id '" << fr.containsZone
           << "' defined in stops.txt, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "contains_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "contains_id", csvp->getCurLine());
     }
 
     FareRule<RouteT> r(route, fr.originZone, fr.destZone, fr.containsZone);
@@ -280,23 +521,21 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed, std::istream* s) const {
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
-  size_t feedPublisherNameFld = csvp.getFieldIndex("feed_publisher_name");
-  size_t feedPublisherUrlFld = csvp.getFieldIndex("feed_publisher_url");
-  size_t feedLangFld = csvp.getOptFieldIndex("feed_lang");
-  size_t feedStartDateFld = csvp.getOptFieldIndex("feed_start_date");
-  size_t feedEndDateFld = csvp.getOptFieldIndex("feed_end_date");
-  size_t feedVersionFld = csvp.getOptFieldIndex("feed_version");
-
-  while (csvp.readNextLine()) {
-    targetFeed->setPublisherName(getString(csvp, feedPublisherNameFld));
-    targetFeed->setPublisherUrl(getString(csvp, feedPublisherUrlFld));
-    targetFeed->setLang(getString(csvp, feedLangFld, ""));
-    targetFeed->setVersion(getString(csvp, feedVersionFld, ""));
-    targetFeed->setStartDate(getServiceDate(csvp, feedStartDateFld, false));
-    targetFeed->setEndDate(getServiceDate(csvp, feedEndDateFld, false));
+void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
+  size_t feedPublisherNameFld = csvp->getFieldIndex("feed_publisher_name");
+  size_t feedPublisherUrlFld = csvp->getFieldIndex("feed_publisher_url");
+  size_t feedLangFld = csvp->getOptFieldIndex("feed_lang");
+  size_t feedStartDateFld = csvp->getOptFieldIndex("feed_start_date");
+  size_t feedEndDateFld = csvp->getOptFieldIndex("feed_end_date");
+  size_t feedVersionFld = csvp->getOptFieldIndex("feed_version");
+
+  while (csvp->readNextLine()) {
+    targetFeed->setPublisherName(getString(*csvp, feedPublisherNameFld));
+    targetFeed->setPublisherUrl(getString(*csvp, feedPublisherUrlFld));
+    targetFeed->setLang(getString(*csvp, feedLangFld, ""));
+    targetFeed->setVersion(getString(*csvp, feedVersionFld, ""));
+    targetFeed->setStartDate(getServiceDate(*csvp, feedStartDateFld, false));
+    targetFeed->setEndDate(getServiceDate(*csvp, feedEndDateFld, false));
   }
 }
 
@@ -318,14 +557,14 @@ inline gtfs::flat::AgencyFlds Parser::getAgencyFlds(CsvParser* csvp) {
 inline bool Parser::nextAgency(CsvParser* csvp, gtfs::flat::Agency* a,
                                const gtfs::flat::AgencyFlds& flds) const {
   if (csvp->readNextLine()) {
-    a->id = getString(*csvp, flds.agencyIdFld, "");
-    a->name = getString(*csvp, flds.agencyNameFld);
-    a->url = getString(*csvp, flds.agencyUrlFld);
-    a->timezone = getString(*csvp, flds.agencyTimezoneFld);
-    a->lang = getString(*csvp, flds.agencyLangFld, "");
-    a->phone = getString(*csvp, flds.agencyPhoneFld, "");
-    a->fare_url = getString(*csvp, flds.agencyFareUrlFld, "");
-    a->agency_email = getString(*csvp, flds.agencyEmailFld, "");
+    a->id = getStringView(*csvp, flds.agencyIdFld, "");
+    a->name = getStringView(*csvp, flds.agencyNameFld);
+    a->url = getStringView(*csvp, flds.agencyUrlFld);
+    a->timezone = getStringView(*csvp, flds.agencyTimezoneFld);
+    a->lang = getStringView(*csvp, flds.agencyLangFld, "");
+    a->phone = getStringView(*csvp, flds.agencyPhoneFld, "");
+    a->fare_url = getStringView(*csvp, flds.agencyFareUrlFld, "");
+    a->agency_email = getStringView(*csvp, flds.agencyEmailFld, "");
 
     return true;
   }
@@ -335,13 +574,18 @@ inline bool Parser::nextAgency(CsvParser* csvp, gtfs::flat::Agency* a,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseAgencies(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
+void Parser::parseAgencies(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                           ParseContext* ctx) const {
   typename AgencyT::Ref a = (typename AgencyT::Ref());
   gtfs::flat::Agency fa;
-  auto flds = getAgencyFlds(&csvp);
+  auto flds = getAgencyFlds(csvp);
+
+  while (nextAgency(csvp, &fa, flds)) {
+    if (!_filter.agencies.empty() && !_filter.agencies.count(fa.id)) {
+      ctx->skipped->agencies.insert(fa.id);
+      continue;
+    }
 
-  while (nextAgency(&csvp, &fa, flds)) {
     if ((typename AgencyT::Ref()) ==
         (a = targetFeed->getAgencies().add(
              gtfs::Agency(fa.id, fa.name, fa.url, fa.timezone, fa.lang,
@@ -349,11 +593,11 @@ void Parser::parseAgencies(gtfs::FEEDB* targetFeed, std::istream* s) const {
       std::stringstream msg;
       msg << "'agency_id' must be dataset unique. Collision with id '"
           << a->getId() << "')";
-      throw ParserException(msg.str(), "agency_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "agency_id", csvp->getCurLine());
     }
   }
 
-  if ((typename AgencyT::Ref()) == a) {
+  if ((typename AgencyT::Ref()) == a && ctx->skipped->agencies.empty()) {
     throw ParserException(
         "the feed has no agency defined."
         " This is a required field.",
@@ -386,15 +630,15 @@ inline gtfs::flat::StopFlds Parser::getStopFlds(CsvParser* csvp) {
 inline bool Parser::nextStop(CsvParser* csvp, gtfs::flat::Stop* s,
                              const gtfs::flat::StopFlds& flds) const {
   if (csvp->readNextLine()) {
-    s->id = getString(*csvp, flds.stopIdFld);
-    s->code = getString(*csvp, flds.stopCodeFld, "");
-    s->name = getString(*csvp, flds.stopNameFld);
-    s->desc = getString(*csvp, flds.stopDescFld, "");
-    s->zone_id = getString(*csvp, flds.zoneIdFld, "");
-    s->stop_url = getString(*csvp, flds.stopUrlFld, "");
-    s->stop_timezone = getString(*csvp, flds.stopTimezoneFld, "");
-    s->platform_code = getString(*csvp, flds.platformCodeFld, "");
-    s->parent_station = getString(*csvp, flds.parentStationFld, "");
+    s->id = getStringView(*csvp, flds.stopIdFld);
+    s->code = getStringView(*csvp, flds.stopCodeFld, "");
+    s->name = getStringView(*csvp, flds.stopNameFld);
+    s->desc = getStringView(*csvp, flds.stopDescFld, "");
+    s->zone_id = getStringView(*csvp, flds.zoneIdFld, "");
+    s->stop_url = getStringView(*csvp, flds.stopUrlFld, "");
+    s->stop_timezone = getStringView(*csvp, flds.stopTimezoneFld, "");
+    s->platform_code = getStringView(*csvp, flds.platformCodeFld, "");
+    s->parent_station = getStringView(*csvp, flds.parentStationFld, "");
     s->lat = getDouble(*csvp, flds.stopLatFld);
     s->lng = getDouble(*csvp, flds.stopLonFld);
     s->wheelchair_boarding = static_cast<gtfs::flat::Stop::WHEELCHAIR_BOARDING>(
@@ -410,16 +654,33 @@ inline bool Parser::nextStop(CsvParser* csvp, gtfs::flat::Stop* s,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseStops(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseStops(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                        ParseContext* ctx) const {
   std::map<std::string, std::pair<size_t, std::string> > parentStations;
 
   gtfs::flat::Stop fs;
-  auto flds = getStopFlds(&csvp);
+  auto flds = getStopFlds(csvp);
+
+  // bounding box of the stops, merged into the feed's box at the end
+  double minLat = std::numeric_limits<double>::max();
+  double minLon = std::numeric_limits<double>::max();
+  double maxLat = std::numeric_limits<double>::lowest();
+  double maxLon = std::numeric_limits<double>::lowest();
 
-  while (nextStop(&csvp, &fs, flds)) {
-    targetFeed->updateBox(fs.lat, fs.lng);
+  while (nextStop(csvp, &fs, flds)) {
+    // the zone may still be referenced by fare rules
+    targetFeed->getZones().insert(fs.zone_id);
+
+    if (fs.lat < _filter.minLat || fs.lat > _filter.maxLat ||
+        fs.lng < _filter.minLng || fs.lng > _filter.maxLng) {
+      ctx->skipped->stops.insert(fs.id);
+      continue;
+    }
+
+    minLat = std::min<double>(minLat, fs.lat);
+    minLon = std::min<double>(minLon, fs.lng);
+    maxLat = std::max<double>(maxLat, fs.lat);
+    maxLon = std::max<double>(maxLon, fs.lng);
 
     const StopT& s =
         StopT(fs.id, fs.code, fs.name, fs.desc, fs.lat, fs.lng, fs.zone_id,
@@ -431,27 +692,32 @@ void Parser::parseStops(gtfs::FEEDB* targetFeed, std::istream* s) const {
         throw ParserException(
             "a stop with location_type 'station' (1) cannot"
             " have a parent station",
-            "parent_station", csvp.getCurLine());
+            "parent_station", csvp->getCurLine());
       }
 
       parentStations[s.getId()] =
-          std::pair<size_t, std::string>(csvp.getCurLine(), fs.parent_station);
+          std::pair<size_t, std::string>(csvp->getCurLine(), fs.parent_station);
     }
 
-    targetFeed->getZones().insert(fs.zone_id);
-
     if (!targetFeed->getStops().add(s)) {
       std::stringstream msg;
       msg << "'stop_id' must be dataset unique. Collision with id '"
           << s.getId() << "')";
-      throw ParserException(msg.str(), "stop_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "stop_id", csvp->getCurLine());
     }
   }
 
+  if (minLat <= maxLat) {
+    targetFeed->updateBox(minLat, minLon);
+    targetFeed->updateBox(maxLat, maxLon);
+  }
+
   targetFeed->getStops().finalize();
 
   // second pass to resolve parentStation pointers
   for (const auto& ps : parentStations) {
+    if (ctx->skipped->stops.count(ps.second.second)) continue;
+
     StopT* parentStation = 0;
     parentStation = targetFeed->getStops().get(ps.second.second);
     if (!parentStation) {
@@ -484,14 +750,14 @@ inline gtfs::flat::RouteFlds Parser::getRouteFlds(CsvParser* csvp) {
 inline bool Parser::nextRoute(CsvParser* csvp, gtfs::flat::Route* r,
                               const gtfs::flat::RouteFlds& flds) const {
   if (csvp->readNextLine()) {
-    r->id = getString(*csvp, flds.routeIdFld);
-    r->agency = getString(*csvp, flds.agencyIdFld, "");
-    r->short_name = getString(*csvp, flds.routeShortNameFld, "");
-    r->long_name = getString(*csvp, flds.routeLongNameFld, "");
-    r->desc = getString(*csvp, flds.routeDescFld, "");
+    r->id = getStringView(*csvp, flds.routeIdFld);
+    r->agency = getStringView(*csvp, flds.agencyIdFld, "");
+    r->short_name = getStringView(*csvp, flds.routeShortNameFld, "");
+    r->long_name = getStringView(*csvp, flds.routeLongNameFld, "");
+    r->desc = getStringView(*csvp, flds.routeDescFld, "");
     r->type = getRouteType(*csvp, flds.routeTypeFld,
                            getRangeInteger(*csvp, flds.routeTypeFld, 0, 1702));
-    r->url = getString(*csvp, flds.routeUrlFld, "");
+    r->url = getStringView(*csvp, flds.routeUrlFld, "");
     r->color = getColorFromHexString(*csvp, flds.routeColorFld, "FFFFFF");
     r->text_color =
         getColorFromHexString(*csvp, flds.routeTextColorFld, "000000");
@@ -504,13 +770,20 @@ inline bool Parser::nextRoute(CsvParser* csvp, gtfs::flat::Route* r,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseRoutes(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseRoutes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                         ParseContext* ctx) const {
   gtfs::flat::Route fr;
-  auto flds = getRouteFlds(&csvp);
+  auto flds = getRouteFlds(csvp);
+
+  while (nextRoute(csvp, &fr, flds)) {
+    // a route without agency_id belongs to the feed's single agency
+    if ((!_filter.routes.empty() && !_filter.routes.count(fr.id)) ||
+        (fr.agency.empty() ? !ctx->skipped->agencies.empty()
+                           : ctx->skipped->agencies.count(fr.agency))) {
+      ctx->skipped->routes.insert(fr.id);
+      continue;
+    }
 
-  while (nextRoute(&csvp, &fr, flds)) {
     typename AgencyT::Ref routeAgency = 0;
 
     if (!fr.agency.empty()) {
@@ -519,7 +792,7 @@ void Parser::parseRoutes(gtfs::FEEDB* targetFeed, std::istream* s) const {
         std::stringstream msg;
         msg << "no agency with id '" << fr.agency << "' defined, cannot "
             << "reference here.";
-        throw ParserException(msg.str(), "agency_id", csvp.getCurLine());
+        throw ParserException(msg.str(), "agency_id", csvp->getCurLine());
       }
     }
 
@@ -529,7 +802,7 @@ void Parser::parseRoutes(gtfs::FEEDB* targetFeed, std::istream* s) const {
       std::stringstream msg;
       msg << "'route_id' must be dataset unique. Collision with id '" << fr.id
           << "')";
-      throw ParserException(msg.str(), "route_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "route_id", csvp->getCurLine());
     }
   }
 
@@ -556,7 +829,7 @@ inline gtfs::flat::CalendarFlds Parser::getCalendarFlds(CsvParser* csvp) {
 inline bool Parser::nextCalendar(CsvParser* csvp, gtfs::flat::Calendar* c,
                                  const gtfs::flat::CalendarFlds& flds) const {
   if (csvp->readNextLine()) {
-    c->id = getString(*csvp, flds.serviceIdFld);
+    c->id = getStringView(*csvp, flds.serviceIdFld);
     c->serviceDays = (getRangeInteger(*csvp, flds.mondayFld, 0, 1)) |
                      (getRangeInteger(*csvp, flds.tuesdayFld, 0, 1) << 1) |
                      (getRangeInteger(*csvp, flds.wednesdayFld, 0, 1) << 2) |
@@ -575,20 +848,25 @@ inline bool Parser::nextCalendar(CsvParser* csvp, gtfs::flat::Calendar* c,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseCalendar(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseCalendar(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                           ParseContext* ctx) const {
   gtfs::flat::Calendar fc;
-  auto flds = getCalendarFlds(&csvp);
+  auto flds = getCalendarFlds(csvp);
+
+  while (nextCalendar(csvp, &fc, flds)) {
+    if ((!_filter.to.empty() && fc.begin > _filter.to) ||
+        (!_filter.from.empty() && fc.end < _filter.from)) {
+      ctx->skipped->services.insert(fc.id);
+      continue;
+    }
 
-  while (nextCalendar(&csvp, &fc, flds)) {
     if ((typename ServiceT::Ref()) ==
         targetFeed->getServices().add(
             ServiceT(fc.id, fc.serviceDays, fc.begin, fc.end))) {
       std::stringstream msg;
       msg << "'service_id' must be unique in calendars.txt. Collision with id '"
           << fc.id << "')";
-      throw ParserException(msg.str(), "service_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "service_id", csvp->getCurLine());
     }
   }
 }
@@ -608,7 +886,7 @@ inline bool Parser::nextCalendarDate(
     CsvParser* csvp, gtfs::flat::CalendarDate* c,
     const gtfs::flat::CalendarDateFlds& flds) const {
   if (csvp->readNextLine()) {
-    c->id = getString(*csvp, flds.serviceIdFld);
+    c->id = getStringView(*csvp, flds.serviceIdFld);
     c->date = getServiceDate(*csvp, flds.dateFld, true);
     c->type = static_cast<gtfs::flat::CalendarDate::EXCEPTION_TYPE>(
         getRangeInteger(*csvp, flds.exceptionTypeFld, 1, 2));
@@ -621,17 +899,28 @@ inline bool Parser::nextCalendarDate(
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed,
-                                std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                                ParseContext* ctx) const {
   gtfs::flat::CalendarDate fc;
-  auto flds = getCalendarDateFlds(&csvp);
+  auto flds = getCalendarDateFlds(csvp);
 
-  while (nextCalendarDate(&csvp, &fc, flds)) {
+  while (nextCalendarDate(csvp, &fc, flds)) {
     ServiceT* e = targetFeed->getServices().get(fc.id);
 
+    if ((!_filter.to.empty() && fc.date > _filter.to) ||
+        (!_filter.from.empty() && fc.date < _filter.from)) {
+      if (!e) ctx->skipped->services.insert(fc.id);
+      continue;
+    }
+
     if (!e) {
+      // removing a day from a service dropped by the window is a no-op
+      if (fc.type == gtfs::flat::CalendarDate::SERVICE_REMOVED &&
+          ctx->skipped->services.count(fc.id)) {
+        continue;
+      }
+
+      ctx->skipped->services.erase(fc.id);
       targetFeed->getServices().add(ServiceT(fc.id));
       e = targetFeed->getServices().get(fc.id);
     }
@@ -662,15 +951,15 @@ inline gtfs::flat::TripFlds Parser::getTripFlds(CsvParser* csvp) {
 inline bool Parser::nextTrip(CsvParser* csvp, gtfs::flat::Trip* c,
                              const gtfs::flat::TripFlds& flds) const {
   if (csvp->readNextLine()) {
-    c->id = getString(*csvp, flds.tripIdFld);
-    c->route = getString(*csvp, flds.routeIdFld);
-    c->service = getString(*csvp, flds.serviceIdFld);
-    c->headsign = getString(*csvp, flds.tripHeadsignFld, "");
-    c->short_name = getString(*csvp, flds.tripShortNameFld, "");
+    c->id = getStringView(*csvp, flds.tripIdFld);
+    c->route = getStringView(*csvp, flds.routeIdFld);
+    c->service = getStringView(*csvp, flds.serviceIdFld);
+    c->headsign = getStringView(*csvp, flds.tripHeadsignFld, "");
+    c->short_name = getStringView(*csvp, flds.tripShortNameFld, "");
     c->dir = static_cast<gtfs::flat::Trip::DIRECTION>(
         getRangeInteger(*csvp, flds.directionIdFld, 0, 1, 2));
-    c->block_id = getString(*csvp, flds.blockIdFld, "");
-    c->shape = getString(*csvp, flds.shapeIdFld, "");
+    c->block_id = getStringView(*csvp, flds.blockIdFld, "");
+    c->shape = getStringView(*csvp, flds.shapeIdFld, "");
     c->wc = static_cast<gtfs::flat::Trip::WC_BIKE_ACCESSIBLE>(
         getRangeInteger(*csvp, flds.wheelchairAccessibleFld, 0, 2, 0)),
     c->ba = static_cast<gtfs::flat::Trip::WC_BIKE_ACCESSIBLE>(
@@ -682,13 +971,18 @@ inline bool Parser::nextTrip(CsvParser* csvp, gtfs::flat::Trip* c,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseTrips(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseTrips(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                        ParseContext* ctx) const {
   gtfs::flat::Trip ft;
-  auto flds = getTripFlds(&csvp);
+  auto flds = getTripFlds(csvp);
+
+  while (nextTrip(csvp, &ft, flds)) {
+    if (ctx->skipped->routes.count(ft.route) ||
+        ctx->skipped->services.count(ft.service)) {
+      ctx->skipped->trips.insert(ft.id);
+      continue;
+    }
 
-  while (nextTrip(&csvp, &ft, flds)) {
     RouteT* tripRoute = 0;
 
     tripRoute = targetFeed->getRoutes().get(ft.route);
@@ -696,7 +990,7 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, std::istream* s) const {
       std::stringstream msg;
       msg << "no route with id '" << ft.route << "' defined, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "route_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "route_id", csvp->getCurLine());
     }
 
     typename ShapeT::Ref tripShape = (typename ShapeT::Ref());
@@ -707,7 +1001,7 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, std::istream* s) const {
         std::stringstream msg;
         msg << "no shape with id '" << ft.shape << "' defined, cannot "
             << "reference here.";
-        throw ParserException(msg.str(), "shape_id", csvp.getCurLine());
+        throw ParserException(msg.str(), "shape_id", csvp->getCurLine());
       }
     }
 
@@ -718,7 +1012,7 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, std::istream* s) const {
       std::stringstream msg;
       msg << "no service with id '" << ft.service << "' defined, cannot "
           << "reference here.";
-      throw ParserException(msg.str(), "service_id", csvp.getCurLine());
+      throw ParserException(msg.str(), "service_id", csvp->getCurLine());
     }
 
     if (typename TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>::Ref() ==
@@ -728,8 +1022,8 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed, std::istream* s) const {
                 ft.dir, ft.block_id, tripShape, ft.wc, ft.ba))) {
       std::stringstream msg;
       msg << "'trip_id' must be dataset unique. Collision with id '"
-          << getString(csvp, flds.tripIdFld) << "')";
-      throw ParserException(msg.str(), "trip_id", csvp.getCurLine());
+          << getString(*csvp, flds.tripIdFld) << "')";
+      throw ParserException(msg.str(), "trip_id", csvp->getCurLine());
     }
   }
 
@@ -751,42 +1045,55 @@ inline gtfs::flat::ShapeFlds Parser::getShapeFlds(CsvParser* csvp) {
 inline bool Parser::nextShapePoint(CsvParser* csvp, gtfs::flat::ShapePoint* c,
                                    const gtfs::flat::ShapeFlds& flds) const {
   if (csvp->readNextLine()) {
-    c->id = getString(*csvp, flds.shapeIdFld);
-    c->lat = getDouble(*csvp, flds.shapePtLatFld);
-    c->lng = getDouble(*csvp, flds.shapePtLonFld);
-    c->seq = getRangeInteger(*csvp, flds.shapePtSequenceFld, 0, UINT32_MAX);
-    c->travelDist = -1;  // using -1 as a null value here
-
-    if (flds.shapeDistTraveledFld < csvp->getNumColumns()) {
-      if (!getString(*csvp, flds.shapeDistTraveledFld, "").empty()) {
-        c->travelDist = getDouble(*csvp, flds.shapeDistTraveledFld);
-        if (c->travelDist < -0.01) {  // TODO(patrick): better double comp
-          throw ParserException(
-              "negative values not supported for distances"
-              " (value was: " +
-                  std::to_string(c->travelDist),
-              "shape_dist_traveled", csvp->getCurLine());
-        }
-      }
-    }
-
+    readShapePoint(csvp, c, flds);
     return true;
   }
 
   return false;
 }
 
+// ____________________________________________________________________________
+inline void Parser::readShapePoint(CsvParser* csvp, gtfs::flat::ShapePoint* c,
+                                   const gtfs::flat::ShapeFlds& flds) const {
+  c->id = getStringView(*csvp, flds.shapeIdFld);
+  c->lat = getDouble(*csvp, flds.shapePtLatFld);
+  c->lng = getDouble(*csvp, flds.shapePtLonFld);
+  c->seq = getRangeInteger(*csvp, flds.shapePtSequenceFld, 0, UINT32_MAX);
+  c->travelDist = -1;  // using -1 as a null value here
+
+  if (flds.shapeDistTraveledFld < csvp->getNumColumns()) {
+    if (!getStringView(*csvp, flds.shapeDistTraveledFld, "").empty()) {
+      c->travelDist = getDouble(*csvp, flds.shapeDistTraveledFld);
+      if (c->travelDist < -0.01) {  // TODO(patrick): better double comp
+        throw ParserException(
+            "negative values not supported for distances"
+            " (value was: " +
+                std::to_string(c->travelDist),
+            "shape_dist_traveled", csvp->getCurLine());
+      }
+    }
+  }
+}
+
 // ____________________________________________________________________________
 FEEDTPL
 void Parser::parseStops(gtfs::FEEDB* targetFeed,
                         const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/stops.txt";
+  ParseContext ctx(path);
+  parseStops(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStops(gtfs::FEEDB* targetFeed,
+                        ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/stops.txt";
   try {
-    fs.open(curFile.c_str());
-    if (!fs.good()) fileNotFound(curFile);
-    parseStops(targetFeed, &fs);
-    fs.close();
+    auto csvp = openTable(*ctx, "stops.txt");
+    if (!csvp->isOpen()) fileNotFound(curFile);
+    parseStops(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -802,13 +1109,21 @@ void Parser::parseStops(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseRoutes(gtfs::FEEDB* targetFeed,
                          const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/routes.txt";
+  ParseContext ctx(path);
+  parseRoutes(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseRoutes(gtfs::FEEDB* targetFeed,
+                         ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/routes.txt";
   try {
-    fs.open(curFile.c_str());
-    if (!fs.good()) fileNotFound(curFile);
-    parseRoutes(targetFeed, &fs);
-    fs.close();
+    auto csvp = openTable(*ctx, "routes.txt");
+    if (!csvp->isOpen()) fileNotFound(curFile);
+    parseRoutes(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -824,14 +1139,20 @@ void Parser::parseRoutes(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseCalendar(gtfs::FEEDB* targetFeed,
                            const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/calendar.txt";
+  ParseContext ctx(path);
+  parseCalendar(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseCalendar(gtfs::FEEDB* targetFeed,
+                           ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/calendar.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseCalendar(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "calendar.txt");
+    if (csvp->isOpen()) parseCalendar(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -847,14 +1168,25 @@ void Parser::parseCalendar(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed,
                                 const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/calendar_dates.txt";
+  ParseContext ctx(path);
+  parseCalendarDates(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed,
+                                ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/calendar_dates.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseCalendarDates(targetFeed, &fs);
-      fs.close();
+    auto csvp = openTable(*ctx, "calendar_dates.txt");
+    if (csvp->isOpen()) {
+      parseCalendarDates(targetFeed, csvp.get(), ctx);
+    } else {
+      // the services of calendar.txt are complete
+      targetFeed->getServices().finalize();
     }
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -870,15 +1202,20 @@ void Parser::parseCalendarDates(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed,
                            const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/feed_info.txt";
+  ParseContext ctx(path);
+  parseFeedInfo(targetFeed, &ctx);
+}
 
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed,
+                           ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/feed_info.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseFeedInfo(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "feed_info.txt");
+    if (csvp->isOpen()) parseFeedInfo(targetFeed, csvp.get());
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -894,13 +1231,21 @@ void Parser::parseFeedInfo(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseAgencies(gtfs::FEEDB* targetFeed,
                            const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/agency.txt";
+  ParseContext ctx(path);
+  parseAgencies(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseAgencies(gtfs::FEEDB* targetFeed,
+                           ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/agency.txt";
   try {
-    fs.open(curFile.c_str());
-    if (!fs.good()) fileNotFound(curFile);
-    parseAgencies(targetFeed, &fs);
-    fs.close();
+    auto csvp = openTable(*ctx, "agency.txt");
+    if (!csvp->isOpen()) fileNotFound(curFile);
+    parseAgencies(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -916,14 +1261,26 @@ void Parser::parseAgencies(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseShapes(gtfs::FEEDB* targetFeed,
                          const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/shapes.txt";
+  ParseContext ctx(path);
+  parseShapes(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseShapes(gtfs::FEEDB* targetFeed,
+                         ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/shapes.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseShapes(targetFeed, &fs);
-      fs.close();
+    auto csvp = openTable(*ctx, "shapes.txt");
+    const char* begin = 0;
+    const char* end = 0;
+    if (_lazy && csvp->getInput(&begin, &end)) {
+      indexShapes(targetFeed, std::move(csvp), curFile);
+    } else if (csvp->isOpen()) {
+      parseShapes(targetFeed, csvp.get());
     }
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -939,13 +1296,21 @@ void Parser::parseShapes(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseTrips(gtfs::FEEDB* targetFeed,
                         const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/trips.txt";
+  ParseContext ctx(path);
+  parseTrips(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseTrips(gtfs::FEEDB* targetFeed,
+                        ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/trips.txt";
   try {
-    fs.open(curFile.c_str());
-    if (!fs.good()) fileNotFound(curFile);
-    parseTrips(targetFeed, &fs);
-    fs.close();
+    auto csvp = openTable(*ctx, "trips.txt");
+    if (!csvp->isOpen()) fileNotFound(curFile);
+    parseTrips(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -961,13 +1326,30 @@ void Parser::parseTrips(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseStopTimes(gtfs::FEEDB* targetFeed,
                             const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/stop_times.txt";
+  ParseContext ctx(path);
+  parseStopTimes(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStopTimes(gtfs::FEEDB* targetFeed,
+                            ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/stop_times.txt";
   try {
-    fs.open(curFile.c_str());
-    if (!fs.good()) fileNotFound(curFile);
-    parseStopTimes(targetFeed, &fs);
-    fs.close();
+    auto csvp = openTable(*ctx, "stop_times.txt");
+    if (!csvp->isOpen()) fileNotFound(curFile);
+
+    const char* begin = 0;
+    const char* end = 0;
+    if (ctx->readStopTimes) {
+      ctx->readStopTimes(csvp.get());
+    } else if (_lazy && csvp->getInput(&begin, &end)) {
+      indexStopTimes(targetFeed, std::move(csvp), curFile, ctx);
+    } else {
+      parseStopTimes(targetFeed, csvp.get(), ctx);
+    }
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -983,14 +1365,20 @@ void Parser::parseStopTimes(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseFareRules(gtfs::FEEDB* targetFeed,
                             const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/fare_rules.txt";
+  ParseContext ctx(path);
+  parseFareRules(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseFareRules(gtfs::FEEDB* targetFeed,
+                            ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/fare_rules.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseFareRules(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "fare_rules.txt");
+    if (csvp->isOpen()) parseFareRules(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -1006,14 +1394,20 @@ void Parser::parseFareRules(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
                                  const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/fare_attributes.txt";
+  ParseContext ctx(path);
+  parseFareAttributes(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
+                                 ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/fare_attributes.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseFareAttributes(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "fare_attributes.txt");
+    if (csvp->isOpen()) parseFareAttributes(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -1029,14 +1423,20 @@ void Parser::parseFareAttributes(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseTransfers(gtfs::FEEDB* targetFeed,
                             const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/transfers.txt";
+  ParseContext ctx(path);
+  parseTransfers(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseTransfers(gtfs::FEEDB* targetFeed,
+                            ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/transfers.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseTransfers(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "transfers.txt");
+    if (csvp->isOpen()) parseTransfers(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -1052,14 +1452,20 @@ void Parser::parseTransfers(gtfs::FEEDB* targetFeed,
 FEEDTPL
 void Parser::parseFrequencies(gtfs::FEEDB* targetFeed,
                               const std::string& path) const {
-  std::ifstream fs;
-  std::string curFile = path + "/frequencies.txt";
+  ParseContext ctx(path);
+  parseFrequencies(targetFeed, &ctx);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseFrequencies(gtfs::FEEDB* targetFeed,
+                              ParseContext* ctx) const {
+  std::string curFile = ctx->path + "/frequencies.txt";
   try {
-    fs.open(curFile.c_str());
-    if (fs.good()) {
-      parseFrequencies(targetFeed, &fs);
-      fs.close();
-    }
+    auto csvp = openTable(*ctx, "frequencies.txt");
+    if (csvp->isOpen()) parseFrequencies(targetFeed, csvp.get(), ctx);
+  } catch (const ZipException& e) {
+    throw ParserException(e.what(), "", -1, curFile.c_str());
   } catch (const CsvParserException& e) {
     throw ParserException(e.getMsg(), e.getFieldName(), e.getLine(),
                           curFile.c_str());
@@ -1073,31 +1479,86 @@ void Parser::parseFrequencies(gtfs::FEEDB* targetFeed,
 
 // ____________________________________________________________________________
 FEEDTPL
-void Parser::parseShapes(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
-
+void Parser::parseShapes(gtfs::FEEDB* targetFeed, CsvParser* csvp) const {
   gtfs::flat::ShapePoint fp;
-  auto flds = getShapeFlds(&csvp);
+  auto flds = getShapeFlds(csvp);
+
+  // bounding box of the shapes, merged into the feed's box at the end
+  double minLat = std::numeric_limits<double>::max();
+  double minLon = std::numeric_limits<double>::max();
+  double maxLat = std::numeric_limits<double>::lowest();
+  double maxLon = std::numeric_limits<double>::lowest();
+
+  // points of the current run of records with the same shape_id, which are
+  // added to the shape in a single batch when the run ends. The buffer is
+  // kept between runs, so it only grows up to the longest run
+  ShapePoints run;
+  ShapeT* s = 0;
+  std::string curId;
+  bool inRun = false;
+
+  // shapes which received points, sorted (if they received them out of
+  // order) and shrunk once at the end
+  std::vector<ShapeT*> loaded;
+
+  auto flush = [&]() {
+    if (s) {
+      s->appendPoints(run);
+      if (loaded.empty() || loaded.back() != s) loaded.push_back(s);
+    }
+    run.clear();
+  };
+
+  while (nextShapePoint(csvp, &fp, flds)) {
+    if (!inRun || fp.id != curId) {
+      flush();
 
-  while (nextShapePoint(&csvp, &fp, flds)) {
-    if (!targetFeed->getShapes().has(fp.id)) {
-      targetFeed->getShapes().add(ShapeT(fp.id));
+      if (!targetFeed->getShapes().has(fp.id)) {
+        targetFeed->getShapes().add(ShapeT(fp.id));
+      }
+
+      s = targetFeed->getShapes().get(fp.id);
+      curId = fp.id;
+      inRun = true;
     }
 
-    auto s = targetFeed->getShapes().get(fp.id);
-    targetFeed->updateBox(fp.lat, fp.lng);
+    minLat = std::min<double>(minLat, fp.lat);
+    minLon = std::min<double>(minLon, fp.lng);
+    maxLat = std::max<double>(maxLat, fp.lat);
+    maxLon = std::max<double>(maxLon, fp.lng);
 
     if (s) {
-      if (!s->addPoint(ShapePoint(fp.lat, fp.lng, fp.travelDist, fp.seq))) {
+      if (!run.empty() && run.back().seq == fp.seq) {
         throw ParserException(
             "shape_pt_sequence collision,"
             "shape_pt_sequence has "
             "to be increasing for a single shape.",
-            "shape_pt_sequence", csvp.getCurLine());
+            "shape_pt_sequence", csvp->getCurLine());
       }
+      run.push_back(ShapePoint(fp.lat, fp.lng, fp.travelDist, fp.seq));
     }
   }
 
+  flush();
+
+  std::unordered_set<ShapeT*> sorted;
+  for (auto shp : loaded) {
+    if (!sorted.insert(shp).second) continue;
+
+    if (!shp->sortPoints()) {
+      // the colliding records are no longer known at this point
+      throw ParserException(
+          "shape_pt_sequence collision in shape '" + shp->getId() +
+              "', shape_pt_sequence has to be increasing for a single shape.",
+          "shape_pt_sequence", -1);
+    }
+  }
+
+  if (minLat <= maxLat) {
+    targetFeed->updateBox(minLat, minLon);
+    targetFeed->updateBox(maxLat, maxLon);
+  }
+
   targetFeed->getShapes().finalize();
 }
 
@@ -1121,45 +1582,7 @@ inline gtfs::flat::StopTimeFlds Parser::getStopTimeFlds(CsvParser* csvp) {
 inline bool Parser::nextStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
                                  const gtfs::flat::StopTimeFlds& flds) const {
   if (csvp->readNextLine()) {
-    s->at = getTime(*csvp, flds.arrivalTimeFld);
-    s->dt = getTime(*csvp, flds.departureTimeFld);
-
-    if (s->at.empty() && !s->dt.empty()) s->at = s->dt;
-    if (s->dt.empty() && !s->at.empty()) s->dt = s->at;
-
-    s->trip = getString(*csvp, flds.tripIdFld);
-    s->s = getString(*csvp, flds.stopIdFld);
-    s->sequence = getRangeInteger(*csvp, flds.stopSequenceFld, 0, UINT32_MAX);
-    s->headsign = getString(*csvp, flds.stopHeadsignFld, "");
-    s->pickupType = static_cast<gtfs::flat::StopTime::PU_DO_TYPE>(
-        getRangeInteger(*csvp, flds.pickUpTypeFld, 0, 3, 0));
-    s->dropOffType = static_cast<gtfs::flat::StopTime::PU_DO_TYPE>(
-        getRangeInteger(*csvp, flds.dropOffTypeFld, 0, 3, 0));
-
-    // if at and dt are empty, default to 0 here
-    s->isTimepoint = getRangeInteger(*csvp, flds.timepointFld, 0, 1,
-                                     !(s->at.empty() && s->dt.empty()));
-
-    if (s->isTimepoint && s->at.empty() && s->dt.empty()) {
-      throw ParserException(
-          "if arrival_time and departure_time are empty, timepoint cannot be 1",
-          "timepoint", csvp->getCurLine());
-    }
-
-    s->shapeDistTravelled = -1;  // using -1 as a null value here
-    if (flds.shapeDistTraveledFld < csvp->getNumColumns()) {
-      if (!getString(*csvp, flds.shapeDistTraveledFld, "").empty()) {
-        s->shapeDistTravelled = getDouble(*csvp, flds.shapeDistTraveledFld);
-        if (s->shapeDistTravelled <
-            -0.01) {  // TODO(patrick): better double comp
-          throw ParserException(
-              "negative values not supported for distances"
-              " (value was: " +
-                  std::to_string(s->shapeDistTravelled),
-              "shape_dist_traveled", csvp->getCurLine());
-        }
-      }
-    }
+    readStopTime(csvp, s, flds);
     return true;
   }
 
@@ -1167,19 +1590,93 @@ inline bool Parser::nextStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
 }
 
 // ____________________________________________________________________________
-FEEDTPL
-void Parser::parseStopTimes(gtfs::FEEDB* targetFeed, std::istream* s) const {
-  CsvParser csvp(s);
+inline void Parser::readStopTime(CsvParser* csvp, gtfs::flat::StopTime* s,
+                                 const gtfs::flat::StopTimeFlds& flds) const {
+  s->at = getTime(*csvp, flds.arrivalTimeFld);
+  s->dt = getTime(*csvp, flds.departureTimeFld);
+
+  if (s->at.empty() && !s->dt.empty()) s->at = s->dt;
+  if (s->dt.empty() && !s->at.empty()) s->dt = s->at;
+
+  s->trip = getStringView(*csvp, flds.tripIdFld);
+  s->s = getStringView(*csvp, flds.stopIdFld);
+  s->sequence = getRangeInteger(*csvp, flds.stopSequenceFld, 0, UINT32_MAX);
+  s->headsign = getStringView(*csvp, flds.stopHeadsignFld, "");
+  s->pickupType = static_cast<gtfs::flat::StopTime::PU_DO_TYPE>(
+      getRangeInteger(*csvp, flds.pickUpTypeFld, 0, 3, 0));
+  s->dropOffType = static_cast<gtfs::flat::StopTime::PU_DO_TYPE>(
+      getRangeInteger(*csvp, flds.dropOffTypeFld, 0, 3, 0));
+
+  // if at and dt are empty, default to 0 here
+  s->isTimepoint = getRangeInteger(*csvp, flds.timepointFld, 0, 1,
+                                   !(s->at.empty() && s->dt.empty()));
+
+  if (s->isTimepoint && s->at.empty() && s->dt.empty()) {
+    throw ParserException(
+        "if arrival_time and departure_time are empty, timepoint cannot be 1",
+        "timepoint", csvp->getCurLine());
+  }
 
-  gtfs::flat::StopTime fst;
-  auto flds = getStopTimeFlds(&csvp);
+  s->shapeDistTravelled = -1;  // using -1 as a null value here
+  if (flds.shapeDistTraveledFld < csvp->getNumColumns()) {
+    if (!getStringView(*csvp, flds.shapeDistTraveledFld, "").empty()) {
+      s->shapeDistTravelled = getDouble(*csvp, flds.shapeDistTraveledFld);
+      if (s->shapeDistTravelled <
+          -0.01) {  // TODO(patrick): better double comp
+        throw ParserException(
+            "negative values not supported for distances"
+            " (value was: " +
+                std::to_string(s->shapeDistTravelled),
+            "shape_dist_traveled", csvp->getCurLine());
+      }
+    }
+  }
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+bool Parser::skipStopTime(const CsvParser& csvp,
+                          const gtfs::flat::StopTimeFlds& flds,
+                          const Skipped& skipped,
+                          StopTimeRefs<TripT, StopT>* refs) const {
+  if (!skipped.trips.empty()) {
+    // only looked up once per run of records with the same trip_id
+    std::string_view trip = csvp.getTStringView(flds.tripIdFld);
+    if (trip != refs->filterTripId) {
+      refs->filterTripId = trip;
+      refs->tripSkipped = skipped.trips.count(refs->filterTripId);
+    }
+    if (refs->tripSkipped) return true;
+  }
+
+  if (!skipped.stops.empty()) {
+    if (skipped.stops.count(csvp.getTStringView(flds.stopIdFld))) return true;
+  }
+
+  return false;
+}
 
-  while (nextStopTime(&csvp, &fst, flds)) {
-    StopT* stop = 0;
-    TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>* trip = 0;
+// ____________________________________________________________________________
+FEEDTPL
+StopTimeT<StopT> Parser::getStopTime(
+    gtfs::FEEDB* targetFeed, const gtfs::flat::StopTime& fst,
+    const CsvParser& csvp,
+    StopTimeRefs<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>, StopT>*
+        refs) const {
+  if (!refs->trip || fst.trip != refs->tripId) {
+    // a new run of records starts
+    refs->stops.swap(refs->prevStops);
+    refs->stops.clear();
+    refs->tripId = fst.trip;
+    refs->trip = targetFeed->getTrips().get(fst.trip);
+  }
 
-    stop = targetFeed->getStops().get(fst.s);
-    trip = targetFeed->getTrips().get(fst.trip);
+  size_t k = refs->stops.size();
+  if (k < refs->prevStops.size() &&
+      refs->prevStops[k].first->getId() == fst.s) {
+    refs->stops.push_back(refs->prevStops[k]);
+  } else {
+    StopT* stop = targetFeed->getStops().get(fst.s);
 
     if (!stop) {
       std::stringstream msg;
@@ -1188,35 +1685,572 @@ void Parser::parseStopTimes(gtfs::FEEDB* targetFeed, std::istream* s) const {
       throw ParserException(msg.str(), "stop_id", csvp.getCurLine());
     }
 
-    if (!trip) {
-      std::stringstream msg;
-      msg << "no trip with id '" << fst.trip
-          << "' defined in trips.txt, cannot "
-          << "reference here.";
-      throw ParserException(msg.str(), "trip_id", csvp.getCurLine());
+    refs->stops.emplace_back(
+        stop, StopTimeT<StopT>::getStopRef(targetFeed->getStops(), stop));
+  }
+
+  if (!refs->trip) {
+    std::stringstream msg;
+    msg << "no trip with id '" << fst.trip
+        << "' defined in trips.txt, cannot "
+        << "reference here.";
+    throw ParserException(msg.str(), "trip_id", csvp.getCurLine());
+  }
+
+  StopTimeT<StopT> st(fst.at, fst.dt, refs->stops.back().second,
+                      fst.sequence,
+                      StopTimeT<StopT>::getHeadsignRef(
+                          &targetFeed->getStringPool(), fst.headsign),
+                      fst.pickupType, fst.dropOffType,
+                      fst.shapeDistTravelled, fst.isTimepoint);
+
+  if (st.getArrivalTime() > st.getDepartureTime()) {
+    throw ParserException("arrival time '" + st.getArrivalTime().toString() +
+                              "' is later than departure time '" +
+                              st.getDepartureTime().toString() +
+                              "'. You cannot depart earlier than you arrive.",
+                          "departure_time", csvp.getCurLine());
+  }
+
+  return st;
+}
+
+// ____________________________________________________________________________
+inline CsvIndex Parser::indexTable(CsvParser* csvp, const std::string& field,
+                                   const std::string& file) const {
+  std::string sidecar = file + ".idx";
+  CsvIndex idx;
+
+  if (_indexCache && idx.read(sidecar, file, field)) return idx;
+
+  idx = CsvIndex(csvp, field);
+
+  if (_indexCache) {
+    try {
+      idx.write(sidecar, file);
+    } catch (const std::runtime_error& e) {
+      // the index is only a cache, go on without it
+    }
+  }
+
+  return idx;
+}
+
+// ____________________________________________________________________________
+template <typename FldsT, typename F>
+void Parser::readRanges(const LazyTable<FldsT>& tbl,
+                        const CsvIndex::Ranges& ranges, F f) const {
+  for (const auto& r : ranges) {
+    if (r.begin > r.stop ||
+        r.stop > static_cast<uint64_t>(tbl.end - tbl.base)) {
+      throw ParserException("index range out of bounds", "", r.line,
+                            tbl.file);
     }
 
-    StopTimeT<StopT> st(fst.at, fst.dt, stop, fst.sequence, fst.headsign,
-                        fst.pickupType, fst.dropOffType, fst.shapeDistTravelled,
-                        fst.isTimepoint);
+    CsvParser csvp(tbl.base + r.begin, tbl.base + r.stop, tbl.end, *tbl.csvp);
 
-    if (st.getArrivalTime() > st.getDepartureTime()) {
-      throw ParserException("arrival time '" + st.getArrivalTime().toString() +
-                                "' is later than departure time '" +
-                                st.getDepartureTime().toString() +
-                                "'. You cannot depart earlier than you arrive.",
-                            "departure_time", csvp.getCurLine());
+    // the range parser numbers lines as if the range followed the whole
+    // table, this is the offset to the actual lines
+    int64_t offset = 0;
+    bool first = true;
+
+    try {
+      while (csvp.readNextLine()) {
+        if (first) offset = r.line - csvp.getCurLine();
+        first = false;
+        f(&csvp);
+      }
+    } catch (const CsvParserException& e) {
+      throw ParserException(e.getMsg(), e.getFieldName(),
+                            e.getLine() + offset, tbl.file);
+    } catch (const ParserException& e) {
+      ParserException fe = e;
+      int64_t line = e.getLine();
+      if (line > -1) fe.setLine(line + offset);
+      fe.setFileName(tbl.file);
+      throw fe;
     }
+  }
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::indexStopTimes(gtfs::FEEDB* targetFeed,
+                            std::unique_ptr<CsvParser> csvp,
+                            const std::string& file,
+                            ParseContext* ctx) const {
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
+
+  auto tbl = std::make_shared<LazyTable<gtfs::flat::StopTimeFlds>>();
+  csvp->getInput(&tbl->base, &tbl->end);
+  tbl->flds = getStopTimeFlds(csvp.get());
+  tbl->file = file;
+
+  CsvIndex idx = indexTable(csvp.get(), "trip_id", file);
+
+  std::unordered_map<TripT*, const CsvIndex::Ranges*> ranges;
+  const std::string* missing = 0;
+  uint64_t missingLine = 0;
+
+  for (const auto& r : idx.getRanges()) {
+    if (ctx->skipped->trips.count(r.first)) continue;
+
+    TripT* trip = targetFeed->getTrips().get(r.first);
+    if (trip) {
+      ranges[trip] = &r.second;
+    } else if (!missing || r.second.front().line < missingLine) {
+      // report the first unknown trip in the file
+      missing = &r.first;
+      missingLine = r.second.front().line;
+    }
+  }
+
+  if (missing) {
+    std::stringstream msg;
+    msg << "no trip with id '" << *missing
+        << "' defined in trips.txt, cannot "
+        << "reference here.";
+    throw ParserException(msg.str(), "trip_id", missingLine);
+  }
+
+  tbl->csvp = std::move(csvp);
+
+  // the loaders read with a copy of this parser, which may be gone by then,
+  // and share the ids dropped by this parse
+  auto parser = std::make_shared<const Parser>(*this);
+  std::shared_ptr<const Skipped> skipped = ctx->skipped;
+
+  for (auto& r : ranges) {
+    TripT* trip = r.first;
+    r.first->setStopTimeLoader(
+        [parser, skipped, tbl, targetFeed, trip, rs = *r.second](
+            std::vector<StopTimeT<StopT>>* sts) {
+          parser->loadStopTimes(targetFeed, *tbl, rs, trip->getId(), *skipped,
+                                sts);
+        });
+  }
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::loadStopTimes(gtfs::FEEDB* targetFeed,
+                           const LazyTable<gtfs::flat::StopTimeFlds>& tbl,
+                           const CsvIndex::Ranges& ranges,
+                           const std::string& tripId, const Skipped& skipped,
+                           std::vector<StopTimeT<StopT>>* sts) const {
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
 
-    if (!trip->addStopTime(st)) {
+  gtfs::flat::StopTime fst;
+  StopTimeRefs<TripT, StopT> refs;
+
+  readRanges(tbl, ranges, [&](CsvParser* csvp) {
+    if (skipStopTime(*csvp, tbl.flds, skipped, &refs)) return;
+    readStopTime(csvp, &fst, tbl.flds);
+    auto st = getStopTime(targetFeed, fst, *csvp, &refs);
+
+    if (!sts->empty() && sts->back().getSeq() == st.getSeq()) {
       throw ParserException(
           "stop_sequence collision, stop_sequence has "
           "to be increasing for a single trip.",
-          "stop_sequence", csvp.getCurLine());
+          "stop_sequence", csvp->getCurLine());
+    }
+
+    sts->push_back(st);
+  });
+
+  auto cmp = gtfs::StopTimeCompare<StopTimeT<StopT>>();
+  if (!std::is_sorted(sts->begin(), sts->end(), cmp)) {
+    std::sort(sts->begin(), sts->end(), cmp);
+  }
+
+  for (size_t i = 1; i < sts->size(); i++) {
+    if ((*sts)[i - 1].getSeq() == (*sts)[i].getSeq()) {
+      throw ParserException(
+          "stop_sequence collision in trip '" + tripId +
+              "', stop_sequence has to be increasing for a single trip.",
+          "stop_sequence", -1, tbl.file);
     }
   }
 }
 
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::indexShapes(gtfs::FEEDB* targetFeed,
+                         std::unique_ptr<CsvParser> csvp,
+                         const std::string& file) const {
+  auto tbl = std::make_shared<LazyTable<gtfs::flat::ShapeFlds>>();
+  csvp->getInput(&tbl->base, &tbl->end);
+  tbl->flds = getShapeFlds(csvp.get());
+  tbl->file = file;
+
+  CsvIndex idx = indexTable(csvp.get(), "shape_id", file);
+
+  std::unordered_map<ShapeT*, const CsvIndex::Ranges*> ranges;
+
+  for (const auto& r : idx.getRanges()) {
+    if (!targetFeed->getShapes().has(r.first)) {
+      targetFeed->getShapes().add(ShapeT(r.first));
+    }
+
+    ShapeT* s = targetFeed->getShapes().get(r.first);
+    if (s) ranges[s] = &r.second;
+  }
+
+  tbl->csvp = std::move(csvp);
+  auto parser = std::make_shared<const Parser>(*this);
+
+  // the loaders do not reference their shape, which may still be moved by
+  // finalize()
+  for (auto& r : ranges) {
+    r.first->setPointLoader([parser, tbl, id = r.first->getId(),
+                             rs = *r.second](ShapePoints* pts) {
+      parser->loadShapePoints(*tbl, rs, id, pts);
+    });
+  }
+
+  targetFeed->getShapes().finalize();
+}
+
+// ____________________________________________________________________________
+inline void Parser::loadShapePoints(const LazyTable<gtfs::flat::ShapeFlds>& tbl,
+                                    const CsvIndex::Ranges& ranges,
+                                    const std::string& shapeId,
+                                    ShapePoints* pts) const {
+  gtfs::flat::ShapePoint fp;
+
+  readRanges(tbl, ranges, [&](CsvParser* csvp) {
+    readShapePoint(csvp, &fp, tbl.flds);
+
+    if (!pts->empty() && pts->back().seq == fp.seq) {
+      throw ParserException(
+          "shape_pt_sequence collision,"
+          "shape_pt_sequence has "
+          "to be increasing for a single shape.",
+          "shape_pt_sequence", csvp->getCurLine());
+    }
+
+    pts->push_back(ShapePoint(fp.lat, fp.lng, fp.travelDist, fp.seq));
+  });
+
+  auto cmp = gtfs::ShapePointCompare();
+  if (!std::is_sorted(pts->begin(), pts->end(), cmp)) {
+    std::sort(pts->begin(), pts->end(), cmp);
+  }
+
+  for (size_t i = 1; i < pts->size(); i++) {
+    if ((*pts)[i - 1].seq == (*pts)[i].seq) {
+      throw ParserException(
+          "shape_pt_sequence collision in shape '" + shapeId +
+              "', shape_pt_sequence has to be increasing for a single shape.",
+          "shape_pt_sequence", -1, tbl.file);
+    }
+  }
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStopTimes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                            ParseContext* ctx) const {
+  const char* begin = 0;
+  const char* end = 0;
+
+  // the parallel mode needs random access to the whole input
+  if (_numThreads > 1 && csvp->getRemaining(&begin, &end)) {
+    parseStopTimes(targetFeed, csvp, begin, end, *ctx->skipped);
+    return;
+  }
+
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
+
+  gtfs::flat::StopTime fst;
+  auto flds = getStopTimeFlds(csvp);
+
+  // stop times are appended unsorted, trips which received them out of
+  // order are sorted once after the whole table has been read
+  std::vector<TripT*> unsorted;
+
+  StopTimeRefs<TripT, StopT> refs;
+
+  while (csvp->readNextLine()) {
+    // records of dropped trips and stops are not converted at all
+    if (skipStopTime(*csvp, flds, *ctx->skipped, &refs)) continue;
+
+    readStopTime(csvp, &fst, flds);
+    auto st = getStopTime(targetFeed, fst, *csvp, &refs);
+
+    if (!appendStopTime(refs.trip, st, &unsorted)) {
+      throw ParserException(
+          "stop_sequence collision, stop_sequence has "
+          "to be increasing for a single trip.",
+          "stop_sequence", csvp->getCurLine());
+    }
+  }
+
+  sortStopTimes(unsorted);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStopTimes(
+    gtfs::FEEDB* targetFeed, CsvParser* csvp, const Skipped& skipped,
+    gtfs::StopTimeColumns<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>,
+                          StopT>* cols) const {
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
+  typedef typename TripT::StopTimes StopTimes;
+
+  gtfs::flat::StopTime fst;
+  auto flds = getStopTimeFlds(csvp);
+
+  StopTimeRefs<TripT, StopT> refs;
+
+  // the stop times of the current run of records with the same trip
+  TripT* trip = 0;
+  StopTimes run;
+
+  // trips whose records do not come in one run, with the stop times of
+  // their later runs. They are added to the columns again at the end
+  std::unordered_map<TripT*, StopTimes> scattered;
+  std::vector<TripT*> scatteredOrder;
+
+  auto sort = [](TripT* t, StopTimes* sts) {
+    auto cmp = gtfs::StopTimeCompare<StopTimeT<StopT>>();
+    if (!std::is_sorted(sts->begin(), sts->end(), cmp)) {
+      std::sort(sts->begin(), sts->end(), cmp);
+    }
+
+    for (size_t i = 1; i < sts->size(); i++) {
+      if ((*sts)[i - 1].getSeq() == (*sts)[i].getSeq()) {
+        // the colliding records are no longer known at this point
+        throw ParserException(
+            "stop_sequence collision in trip '" + t->getId() +
+                "', stop_sequence has to be increasing for a single trip.",
+            "stop_sequence", -1);
+      }
+    }
+  };
+
+  auto flush = [&]() {
+    if (!trip) return;
+
+    if (cols->has(trip) || scattered.count(trip)) {
+      auto& later = scattered[trip];
+      if (later.empty()) scatteredOrder.push_back(trip);
+      later.insert(later.end(), run.begin(), run.end());
+    } else {
+      sort(trip, &run);
+      cols->add(trip, run);
+    }
+
+    run.clear();
+  };
+
+  while (csvp->readNextLine()) {
+    // records of dropped trips and stops are not converted at all
+    if (skipStopTime(*csvp, flds, skipped, &refs)) continue;
+
+    readStopTime(csvp, &fst, flds);
+    auto st = getStopTime(targetFeed, fst, *csvp, &refs);
+
+    if (refs.trip != trip) {
+      flush();
+      trip = refs.trip;
+    }
+
+    if (!run.empty() && run.back().getSeq() == st.getSeq()) {
+      throw ParserException(
+          "stop_sequence collision, stop_sequence has "
+          "to be increasing for a single trip.",
+          "stop_sequence", csvp->getCurLine());
+    }
+
+    run.push_back(st);
+  }
+
+  flush();
+
+  if (scattered.empty()) return;
+
+  std::unordered_set<const TripT*> readd;
+  for (auto t : scatteredOrder) {
+    StopTimes& sts = scattered[t];
+    StopTimes first = cols->getStopTimes(t);
+    sts.insert(sts.begin(), first.begin(), first.end());
+    sort(t, &sts);
+    readd.insert(t);
+  }
+
+  cols->remove(readd);
+  for (auto t : scatteredOrder) cols->add(t, scattered[t]);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopTimeT>
+bool Parser::appendStopTime(TripT* trip, const StopTimeT& st,
+                            std::vector<TripT*>* unsorted) {
+  const auto& sts = trip->getStopTimes();
+  if (!sts.empty() && sts.back().getSeq() == st.getSeq()) return false;
+
+  if (!trip->appendStopTime(st) &&
+      (unsorted->empty() || unsorted->back() != trip)) {
+    unsorted->push_back(trip);
+  }
+
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename TripT>
+void Parser::sortStopTimes(const std::vector<TripT*>& unsorted) {
+  std::unordered_set<TripT*> sorted;
+
+  for (auto trip : unsorted) {
+    if (!sorted.insert(trip).second) continue;
+
+    if (!trip->sortStopTimes()) {
+      // the colliding records are no longer known at this point
+      throw ParserException(
+          "stop_sequence collision in trip '" + trip->getId() +
+              "', stop_sequence has to be increasing for a single trip.",
+          "stop_sequence", -1);
+    }
+  }
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStopTimes(gtfs::FEEDB* targetFeed, CsvParser* csvp,
+                            const char* begin, const char* end,
+                            const Skipped& skipped) const {
+  typedef TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT> TripT;
+  typedef StopTimeChunk<TripT, StopTimeT<StopT>> Chunk;
+
+  // nominal size of the byte ranges parsed by a single thread
+  const size_t CHUNK_SIZE = 1 << 22;
+
+  auto flds = getStopTimeFlds(csvp);
+
+  // split the input at the line starts following the nominal chunk borders.
+  // Such a line start may still lie inside a quoted field spanning multiple
+  // lines, which is detected below by checking that the previous chunk
+  // ended exactly at the chunk's begin
+  std::vector<Chunk> chunks;
+  for (const char* p = begin; p < end;) {
+    Chunk c;
+    c.begin = p;
+    c.end = 0;
+    c.stop = end;
+
+    if (static_cast<size_t>(end - p) > CHUNK_SIZE) {
+      const char* nom = p + CHUNK_SIZE;
+      const char* nl = static_cast<const char*>(memchr(nom, '\n', end - nom));
+      if (nl) c.stop = nl + 1;
+    }
+
+    chunks.push_back(c);
+    p = c.stop;
+  }
+
+  // declared after chunks, so that running threads are joined before the
+  // chunks are destroyed
+  std::vector<std::future<void>> futures(chunks.size());
+
+  size_t next = 0;
+  auto launch = [&]() {
+    Chunk* c = &chunks[next++];
+    futures[next - 1] = std::async(
+        std::launch::async, [this, targetFeed, csvp, &flds, &skipped, c]() {
+          parseStopTimesChunk(targetFeed, *csvp, flds, skipped, c);
+        });
+  };
+
+  while (next < chunks.size() && next < _numThreads) launch();
+
+  // merge the chunks in input order, as the serial mode would
+  std::vector<TripT*> unsorted;
+  const char* prevEnd = begin;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    futures[i].get();
+    if (next < chunks.size()) launch();
+
+    Chunk& c = chunks[i];
+
+    if (c.begin != prevEnd) {
+      // the chunk did not start at a record, parse it again from the end of
+      // the previous one
+      c.begin = prevEnd;
+      c.stopTimes.clear();
+      c.err = std::exception_ptr();
+      parseStopTimesChunk(targetFeed, *csvp, flds, skipped, &c);
+    }
+
+    for (size_t j = 0; j < c.stopTimes.size(); j++) {
+      if (appendStopTime(c.stopTimes[j].first, c.stopTimes[j].second,
+                         &unsorted)) {
+        continue;
+      }
+
+      // find the line of the colliding record
+      CsvParser lp(c.begin, c.stop, end, *csvp);
+      for (size_t k = 0; k <= j; k++) lp.readNextLine();
+
+      throw ParserException(
+          "stop_sequence collision, stop_sequence has "
+          "to be increasing for a single trip.",
+          "stop_sequence",
+          lp.getCurLine() + std::count(begin, c.begin, '\n'));
+    }
+
+    if (c.err) {
+      try {
+        std::rethrow_exception(c.err);
+      } catch (ParserException& e) {
+        // the chunk's line numbers do not include the lines before it
+        int64_t line = e.getLine();
+        if (line > -1) e.setLine(line + std::count(begin, c.begin, '\n'));
+        throw;
+      }
+    }
+
+    prevEnd = c.end;
+    std::vector<std::pair<TripT*, StopTimeT<StopT>>>().swap(c.stopTimes);
+  }
+
+  sortStopTimes(unsorted);
+}
+
+// ____________________________________________________________________________
+FEEDTPL
+void Parser::parseStopTimesChunk(
+    gtfs::FEEDB* targetFeed, const CsvParser& hdr,
+    const gtfs::flat::StopTimeFlds& flds, const Skipped& skipped,
+    StopTimeChunk<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>,
+                  StopTimeT<StopT>>* chunk) const {
+  const char* begin = 0;
+  const char* end = 0;
+  hdr.getRemaining(&begin, &end);
+
+  CsvParser csvp(chunk->begin, chunk->stop, end, hdr);
+  gtfs::flat::StopTime fst;
+  StopTimeRefs<TripB<StopTimeT<StopT>, ServiceT, RouteT, ShapeT>, StopT> refs;
+
+  try {
+    while (csvp.readNextLine()) {
+      if (skipStopTime(csvp, flds, skipped, &refs)) continue;
+
+      readStopTime(&csvp, &fst, flds);
+      auto st = getStopTime(targetFeed, fst, csvp, &refs);
+      chunk->stopTimes.push_back({refs.trip, st});
+    }
+  } catch (const CsvParserException& e) {
+    chunk->err = std::make_exception_ptr(
+        ParserException(e.getMsg(), e.getFieldName(), e.getLine()));
+  } catch (...) {
+    chunk->err = std::current_exception();
+  }
+
+  csvp.getRemaining(&chunk->end, &end);
+}
+
 // ___________________________________________________________________________
 void Parser::fileNotFound(const std::string& file) const {
   throw ParserException("File not found", "", -1, std::string(file.c_str()));
@@ -1224,8 +2258,24 @@ void Parser::fileNotFound(const std::string& file) const {
 
 // ___________________________________________________________________________
 std::string Parser::getString(const CsvParser& csv, size_t field) const {
-  const char* r = csv.getTString(field);
-  if (r[0] == 0) {
+  return std::string(getStringView(csv, field));
+}
+
+// ___________________________________________________________________________
+std::string Parser::getString(const CsvParser& csv, size_t field,
+                              const std::string& def) const {
+  if (field < csv.getNumColumns() && !csv.fieldIsEmpty(field)) {
+    return std::string(csv.getTStringView(field));
+  }
+
+  return def;
+}
+
+// ___________________________________________________________________________
+std::string_view Parser::getStringView(const CsvParser& csv,
+                                       size_t field) const {
+  auto r = csv.getTStringView(field);
+  if (r.empty()) {
     throw ParserException("expected non-empty string", csv.getFieldName(field),
                           csv.getCurLine());
   }
@@ -1233,10 +2283,10 @@ std::string Parser::getString(const CsvParser& csv, size_t field) const {
 }
 
 // ___________________________________________________________________________
-std::string Parser::getString(const CsvParser& csv, size_t field,
-                              const std::string& def) const {
+std::string_view Parser::getStringView(const CsvParser& csv, size_t field,
+                                       std::string_view def) const {
   if (field < csv.getNumColumns() && !csv.fieldIsEmpty(field)) {
-    return csv.getTString(field);
+    return csv.getTStringView(field);
   }
 
   return def;
@@ -1300,7 +2350,7 @@ uint32_t Parser::getColorFromHexString(const CsvParser& csv, size_t field,
   std::string color_string;
 
   if (field < csv.getNumColumns()) {
-    color_string = csv.getTString(field);
+    color_string = csv.getTStringView(field);
   }
 
   if (color_string.empty()) color_string = def;
@@ -1346,27 +2396,30 @@ ServiceDate Parser::getServiceDate(const CsvParser& csv, size_t field) const {
 // ____________________________________________________________________________
 ServiceDate Parser::getServiceDate(const CsvParser& csv, size_t field,
                                    bool req) const {
-  const char* val = csv.getTString(field);
-  if (strlen(val) == 0 && !req) return ServiceDate();
+  auto str = csv.getTStringView(field);
+  if (str.empty() && !req) return ServiceDate();
+
+  const char* val = str.data();
+  const char* end = str.data() + str.size();
 
   try {
-    uint32_t yyyymmdd = atoi(&val);
-    if (*val != 0 || yyyymmdd > 99999999) {
+    uint32_t yyyymmdd = atoi(&val, end);
+    if (val != end || yyyymmdd > 99999999) {
       std::stringstream msg;
-      msg << "expected a date in the YYYYMMDD format, found '"
-          << csv.getTString(field) << "' instead.";
+      msg << "expected a date in the YYYYMMDD format, found '" << str
+          << "' instead.";
       throw ParserException(msg.str(), csv.getFieldName(field),
                             csv.getCurLine());
     }
     return ServiceDate(yyyymmdd);
   } catch (const std::out_of_range& e) {
     std::stringstream msg;
-    msg << "expected a date in the YYYYMMDD format, found '" << val
+    msg << "expected a date in the YYYYMMDD format, found '" << str
         << "' instead. (Integer out of range).";
     throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine());
   } catch (const std::invalid_argument& e) {
     std::stringstream msg;
-    msg << "expected a date in the YYYYMMDD format, found '" << val
+    msg << "expected a date in the YYYYMMDD format, found '" << str
         << "' instead.";
     throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine());
   }
@@ -1374,25 +2427,27 @@ ServiceDate Parser::getServiceDate(const CsvParser& csv, size_t field,
 
 // ____________________________________________________________________________
 Time Parser::getTime(const CsvParser& csv, size_t field) const {
-  const char* val = csv.getTString(field);
+  auto str = csv.getTStringView(field);
 
   // TODO(patrick): null value
-  if (val[0] == 0) return Time();
+  if (str.empty()) return Time();
+
+  const char* val = str.data();
+  const char* end = str.data() + str.size();
 
   try {
-    uint32_t h = atoi(&val);
+    uint32_t h = atoi(&val, end);
     if (h > 255)
       throw std::out_of_range(
           "only non-negative hour-values up to 255 are "
           "supported.");
-    if (*val != ':') {
-      std::cout << *val << std::endl;
+    if (val == end || *val != ':') {
       throw std::invalid_argument("invalid separator");
     }
 
     val++;
 
-    uint32_t m = atoi(&val);
+    uint32_t m = atoi(&val, end);
     // allow values of 60, although standard forbids it
     if (m > 60)
       throw std::out_of_range(
@@ -1402,9 +2457,9 @@ Time Parser::getTime(const CsvParser& csv, size_t field) const {
     // allow missing second values, although standard forbids it
     uint32_t s = 0;
 
-    if (*val == ':') {
+    if (val != end && *val == ':') {
       val++;
-      s = atoi(&val);
+      s = atoi(&val, end);
     }
 
     // allow values of 60, although standard forbids it
@@ -1416,8 +2471,8 @@ Time Parser::getTime(const CsvParser& csv, size_t field) const {
     return Time(h, m % 60, s % 60);
   } catch (const std::exception& e) {
     std::stringstream msg;
-    msg << "expected a time in HH:MM:SS (or H:MM:SS) format, found '"
-        << csv.getTString(field) << "' instead. (" << e.what() << ")";
+    msg << "expected a time in HH:MM:SS (or H:MM:SS) format, found '" << str
+        << "' instead. (" << e.what() << ")";
     throw ParserException(msg.str(), csv.getFieldName(field), csv.getCurLine());
   }
 }
@@ -1435,10 +2490,10 @@ gtfs::flat::Route::TYPE Parser::getRouteType(const CsvParser& csv, size_t field,
 }
 
 // ___________________________________________________________________________
-inline uint32_t Parser::atoi(const char** p) {
+inline uint32_t Parser::atoi(const char** p, const char* end) {
   uint32_t x = 0;
-  if (**p < '0' || **p > '9') return -1;
-  while (**p >= '0' && **p <= '9') {
+  if (*p == end || **p < '0' || **p > '9') return -1;
+  while (*p < end && **p >= '0' && **p <= '9') {
     x = (x * 10) + (**p - '0');
     ++(*p);
   }
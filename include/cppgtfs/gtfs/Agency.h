@@ -18,7 +18,7 @@ namespace gtfs {
 class Agency {
  public:
   typedef Agency* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
 
   Agency() {}
 
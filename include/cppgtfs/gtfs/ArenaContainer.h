@@ -0,0 +1,76 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_ARENACONTAINER_H_
+#define AD_CPPGTFS_GTFS_ARENACONTAINER_H_
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Like Container, but the entities are allocated in slabs of growing size
+// instead of one by one. Entities added together are close to each other in
+// memory, their pointers stay valid, and all of them are released at once
+// when the container is destroyed. Removed entities keep their memory until
+// then.
+template <typename T>
+class ArenaContainer {
+ public:
+  typedef std::unordered_map<std::string_view, T*> Map;
+
+  ArenaContainer() : _used(0) {}
+  ArenaContainer(const ArenaContainer&) = delete;
+  ArenaContainer& operator=(const ArenaContainer&) = delete;
+  ~ArenaContainer();
+
+  T* add(const T& obj);
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const { return get(id); }
+  T* getRef(std::string_view id) { return get(id); }
+  size_t size() const;
+  void finalize() {};
+
+  typename Map::const_iterator begin() const;
+  typename Map::iterator begin();
+
+  typename Map::const_iterator end() const;
+  typename Map::iterator end();
+
+ private:
+  struct Slab {
+    T* mem;
+    size_t cap;
+  };
+
+  static constexpr size_t MIN_SLAB = 64;
+  static constexpr size_t MAX_SLAB = 16384;
+
+  Map _map;
+  std::vector<Slab> _slabs;
+
+  // number of entities constructed in the last slab
+  size_t _used;
+
+  // Returns uninitialized memory for the next entity.
+  T* next();
+};
+
+#include <cppgtfs/gtfs/ArenaContainer.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_ARENACONTAINER_H_
@@ -0,0 +1,99 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename T>
+ArenaContainer<T>::~ArenaContainer() {
+  std::allocator<T> alloc;
+  for (size_t i = 0; i < _slabs.size(); i++) {
+    size_t n = i + 1 == _slabs.size() ? _used : _slabs[i].cap;
+    for (size_t j = 0; j < n; j++) _slabs[i].mem[j].~T();
+    alloc.deallocate(_slabs[i].mem, _slabs[i].cap);
+  }
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ArenaContainer<T>::next() {
+  if (_slabs.empty() || _used == _slabs.back().cap) {
+    size_t cap = _slabs.empty() ? MIN_SLAB
+                                : std::min(_slabs.back().cap * 2, MAX_SLAB);
+    _slabs.push_back(Slab{std::allocator<T>().allocate(cap), cap});
+    _used = 0;
+  }
+  return _slabs.back().mem + _used;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ArenaContainer<T>::add(const T& ent) {
+  T* c = new (next()) T(ent);
+  _used++;
+  if (_map.emplace(T::getId(c), c).second) return c;
+
+  // the slot was the last one taken, give it back
+  c->~T();
+  _used--;
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool ArenaContainer<T>::remove(std::string_view id) {
+  return _map.erase(id);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ArenaContainer<T>::get(std::string_view id) {
+  auto i = _map.find(id);
+  if (i != _map.end()) return i->second;
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* ArenaContainer<T>::get(std::string_view id) const {
+  auto i = _map.find(id);
+  if (i != _map.end()) return i->second;
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool ArenaContainer<T>::has(std::string_view id) const {
+  return (_map.find(id) != _map.end());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+size_t ArenaContainer<T>::size() const {
+  return _map.size();
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ArenaContainer<T>::Map::const_iterator ArenaContainer<T>::begin()
+    const {
+  return _map.begin();
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ArenaContainer<T>::Map::iterator ArenaContainer<T>::begin() {
+  return _map.begin();
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ArenaContainer<T>::Map::const_iterator ArenaContainer<T>::end()
+    const {
+  return _map.end();
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ArenaContainer<T>::Map::iterator ArenaContainer<T>::end() {
+  return _map.end();
+}
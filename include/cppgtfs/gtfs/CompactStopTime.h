@@ -0,0 +1,111 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_COMPACTSTOPTIME_H_
+#define AD_CPPGTFS_GTFS_COMPACTSTOPTIME_H_
+
+#include <stdint.h>
+#include <string>
+#include <cppgtfs/gtfs/StopTime.h>
+#include <cppgtfs/gtfs/StringPool.h>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Drop-in replacement for StopTime (as the StopTimeT of a feed) with half
+// its size: the times are stored as seconds since midnight, and the
+// headsign as a reference into the StringPool of the feed. The times are
+// returned by value. The stop time must not outlive the feed.
+template <typename StopT>
+class CompactStopTime {
+ public:
+  typedef flat::StopTime::PU_DO_TYPE PU_DO_TYPE;
+
+  // what a stop time holds to refer to its stop
+  typedef typename StopT::Ref StopRef;
+
+  // what a stop time holds to refer to its headsign
+  typedef StringPool::Ref HeadsignRef;
+
+  // Returns the StopRef of s, one of the stops of a feed.
+  template <typename StopsT>
+  static StopRef getStopRef(const StopsT&, typename StopT::Ref s) {
+    return s;
+  }
+
+  // Returns the HeadsignRef of hs, added to pool, the pool of a feed.
+  static HeadsignRef getHeadsignRef(StringPool* pool, const std::string& hs) {
+    return pool->ref(hs);
+  }
+
+  CompactStopTime(const Time& at, const Time& dt, typename StopT::Ref s,
+                  uint32_t seq, HeadsignRef hs, PU_DO_TYPE put,
+                  PU_DO_TYPE dot, float distTrav, bool isTp)
+      : _s(s),
+        _at(toSeconds(at)),
+        _dt(toSeconds(dt)),
+        _sequence(seq),
+        _headsign(hs.i),
+        _shapeDistTravelled(distTrav),
+        _pool(hs.pool),
+        _pickupType(put),
+        _dropOffType(dot),
+        _isTimepoint(isTp) {}
+
+  Time getArrivalTime() const { return fromSeconds(_at); }
+  Time getDepartureTime() const { return fromSeconds(_dt); }
+
+  // times in seconds since midnight, or -1 if empty
+  int32_t getArrivalSeconds() const { return _at; }
+  int32_t getDepartureSeconds() const { return _dt; }
+
+  const typename StopT::Ref getStop() const { return _s; }
+  typename StopT::Ref getStop() { return _s; }
+  StopRef getStopRef() const { return _s; }
+  HeadsignRef getHeadsignRef() const { return HeadsignRef{_pool, _headsign}; }
+  const std::string& getHeadsign() const {
+    return StringPool::get(getHeadsignRef());
+  }
+
+  PU_DO_TYPE getPickupType() const {
+    return static_cast<PU_DO_TYPE>(_pickupType);
+  }
+
+  PU_DO_TYPE getDropOffType() const {
+    return static_cast<PU_DO_TYPE>(_dropOffType);
+  }
+
+  float getShapeDistanceTravelled() const { return _shapeDistTravelled; }
+  void setShapeDistanceTravelled(float d) { _shapeDistTravelled = d; }
+  bool isTimepoint() const { return _isTimepoint; }
+  uint32_t getSeq() const { return _sequence; }
+
+ private:
+  typename StopT::Ref _s;
+  int32_t _at;
+  int32_t _dt;
+  uint32_t _sequence;
+  uint32_t _headsign;
+  float _shapeDistTravelled;
+  uint16_t _pool;
+  uint8_t _pickupType : 2;
+  uint8_t _dropOffType : 2;
+  bool _isTimepoint : 1;
+
+  static int32_t toSeconds(const Time& t) {
+    return t.empty() ? -1 : t.seconds();
+  }
+
+  static Time fromSeconds(int32_t s) {
+    if (s < 0) return Time();
+    return Time(s / 3600, (s / 60) % 60, s % 60);
+  }
+};
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_COMPACTSTOPTIME_H_
@@ -0,0 +1,121 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_CONCURRENTCONTAINER_H_
+#define AD_CPPGTFS_GTFS_CONCURRENTCONTAINER_H_
+
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Like Container, but add(), get() and has() may be called from several
+// threads at the same time. The entities are distributed over shards by
+// the hash of their id, each shard has its own lock. After finalize(), the
+// container is read-only and lookups no longer lock. Removed entities are
+// freed.
+template <typename T>
+class ConcurrentContainer {
+ public:
+  typedef std::unordered_map<std::string_view, T*> Map;
+  typedef typename Map::value_type value_type;
+
+ private:
+  static constexpr size_t SHARDS = 64;
+
+  // aligned to keep the locks of different shards on different cache lines
+  struct alignas(64) Shard {
+    mutable std::mutex m;
+    Map map;
+  };
+
+ public:
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ConcurrentContainer::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef const value_type& reference;
+
+    const_iterator() : _cur(0), _end(0) {}
+    const_iterator(const Shard* cur, const Shard* end) : _cur(cur), _end(end) {
+      if (_cur != _end) _it = _cur->map.begin();
+      skip();
+    }
+
+    reference operator*() const { return *_it; }
+    pointer operator->() const { return &*_it; }
+    const_iterator& operator++() {
+      ++_it;
+      skip();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator r = *this;
+      ++*this;
+      return r;
+    }
+    bool operator==(const const_iterator& o) const {
+      return _cur == o._cur && (_cur == _end || _it == o._it);
+    }
+    bool operator!=(const const_iterator& o) const { return !(*this == o); }
+
+   private:
+    const Shard* _cur;
+    const Shard* _end;
+    typename Map::const_iterator _it;
+
+    // moves on to the next shard while the current one is exhausted
+    void skip() {
+      while (_cur != _end && _it == _cur->map.end()) {
+        if (++_cur != _end) _it = _cur->map.begin();
+      }
+    }
+  };
+  typedef const_iterator iterator;
+
+  ConcurrentContainer() : _size(0), _final(false) {}
+  ConcurrentContainer(const ConcurrentContainer&) = delete;
+  ConcurrentContainer& operator=(const ConcurrentContainer&) = delete;
+  ~ConcurrentContainer();
+
+  T* add(const T& obj);
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const { return get(id); }
+  T* getRef(std::string_view id) { return get(id); }
+  size_t size() const { return _size; }
+
+  // No more entities may be added or removed after this.
+  void finalize() { _final = true; }
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+ private:
+  Shard _shards[SHARDS];
+  std::atomic<size_t> _size;
+  std::atomic<bool> _final;
+
+  static size_t shard(std::string_view id);
+};
+
+#include <cppgtfs/gtfs/ConcurrentContainer.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_CONCURRENTCONTAINER_H_
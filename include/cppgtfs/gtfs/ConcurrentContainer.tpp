@@ -0,0 +1,103 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename T>
+ConcurrentContainer<T>::~ConcurrentContainer() {
+  for (auto& s : _shards) {
+    for (auto i : s.map) delete i.second;
+  }
+}
+
+// ____________________________________________________________________________
+template <typename T>
+size_t ConcurrentContainer<T>::shard(std::string_view id) {
+  size_t h = std::hash<std::string_view>()(id);
+  return (h ^ (h >> 32)) % SHARDS;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ConcurrentContainer<T>::add(const T& ent) {
+  if (_final)
+    throw std::runtime_error("Can't add to a finalized concurrent container.");
+
+  T* c = new T(ent);
+  Shard& s = _shards[shard(T::getId(c))];
+
+  {
+    std::lock_guard<std::mutex> lock(s.m);
+    if (s.map.emplace(T::getId(c), c).second) {
+      _size++;
+      return c;
+    }
+  }
+
+  delete c;
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool ConcurrentContainer<T>::remove(std::string_view id) {
+  if (_final) {
+    throw std::runtime_error("Can't remove " + std::string(id) +
+                             " from a finalized concurrent container.");
+  }
+
+  Shard& s = _shards[shard(id)];
+  T* c = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(s.m);
+    auto i = s.map.find(id);
+    if (i == s.map.end()) return false;
+    c = i->second;
+    s.map.erase(i);
+    _size--;
+  }
+
+  delete c;
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ConcurrentContainer<T>::get(std::string_view id) {
+  return const_cast<T*>(
+      static_cast<const ConcurrentContainer<T>*>(this)->get(id));
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* ConcurrentContainer<T>::get(std::string_view id) const {
+  const Shard& s = _shards[shard(id)];
+
+  std::unique_lock<std::mutex> lock(s.m, std::defer_lock);
+  if (!_final) lock.lock();
+
+  auto i = s.map.find(id);
+  if (i != s.map.end()) return i->second;
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool ConcurrentContainer<T>::has(std::string_view id) const {
+  return get(id) != 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ConcurrentContainer<T>::const_iterator ConcurrentContainer<T>::begin()
+    const {
+  return const_iterator(_shards, _shards + SHARDS);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename ConcurrentContainer<T>::const_iterator ConcurrentContainer<T>::end()
+    const {
+  return const_iterator(_shards + SHARDS, _shards + SHARDS);
+}
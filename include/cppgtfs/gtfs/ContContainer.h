@@ -5,25 +5,40 @@
 #ifndef AD_CPPGTFS_GTFS_CONTCONTAINER_H_
 #define AD_CPPGTFS_GTFS_CONTCONTAINER_H_
 
+#include <stdint.h>
 #include <algorithm>
+#include <deque>
+#include <functional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace ad {
 namespace cppgtfs {
 namespace gtfs {
 
+// Entities stored contiguously, sorted by id on finalize(). Lookups go
+// through a compact index of (id hash, position) pairs in Eytzinger (BFS)
+// order, whose top levels stay in cache, instead of a binary search over the
+// entities themselves.
+//
+// Until finalize(), added entities are kept in a staging area, where they
+// can already be looked up and where the pointers returned by add() and
+// get() stay valid. finalize() moves them into place, which invalidates
+// these pointers. Only finalized entities are iterated.
 template <typename T>
 class ContContainer {
  public:
   ContContainer() : _final(false){};
   T* add(const T& obj);
-  bool remove(const std::string& id);
-  const T* get(const std::string& id) const;
-  T* get(const std::string& id);
-  const T* getRef(const std::string& id) const;
-  T* getRef(const std::string& id);
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const;
+  T* getRef(std::string_view id);
   size_t size() const;
 
   void finalize();
@@ -35,8 +50,29 @@ class ContContainer {
   typename std::vector<T>::iterator end();
 
  private:
+  struct IdxEntry {
+    uint32_t hash;
+    uint32_t pos;
+  };
+
   std::vector<T> _vec;
   bool _final;
+
+  // entities added before finalize(), and their positions by the hash of
+  // their id
+  std::deque<T> _staged;
+  std::unordered_multimap<uint32_t, size_t> _stagedIdx;
+
+  // _idx[1..n] in Eytzinger order, _idx[0] is unused
+  std::vector<IdxEntry> _idx;
+
+  static uint32_t hash(std::string_view id);
+
+  // Fills _idx at k and below from sorted, starting at *i.
+  void fillIdx(const std::vector<IdxEntry>& sorted, size_t* i, size_t k);
+
+  // Returns the entity with the given id, or 0.
+  const T* find(std::string_view id) const;
 };
 
 template <typename T>
@@ -48,7 +84,7 @@ struct ContCompCmp {
 
 template <typename T>
 struct ContCompCmp2 {
-  bool operator()(const T& lh, const std::string& rh) const {
+  bool operator()(const T& lh, std::string_view rh) const {
     return lh.getId() < rh;
   }
 };
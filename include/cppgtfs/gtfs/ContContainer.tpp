@@ -7,68 +7,130 @@ template <typename T>
 T* ContContainer<T>::add(const T& ent) {
   if (_final)
     throw std::runtime_error("Can't add to a finalized continuous container.");
-  ;
-  _vec.push_back(ent);
-  return &_vec.back();
+  if (find(ent.getId())) return 0;
+
+  _stagedIdx.emplace(hash(ent.getId()), _staged.size());
+  _staged.push_back(ent);
+  return &_staged.back();
 }
 
 // ____________________________________________________________________________
 template <typename T>
 void ContContainer<T>::finalize() {
+  _vec.reserve(_vec.size() + _staged.size());
+  for (auto& ent : _staged) _vec.push_back(std::move(ent));
+  std::deque<T>().swap(_staged);
+  std::unordered_multimap<uint32_t, size_t>().swap(_stagedIdx);
+
   auto cmp = ContCompCmp<T>();
   std::sort(_vec.begin(), _vec.end(), cmp);
+
+  std::vector<IdxEntry> sorted(_vec.size());
+  for (size_t i = 0; i < _vec.size(); i++) {
+    sorted[i] = IdxEntry{hash(_vec[i].getId()), static_cast<uint32_t>(i)};
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const IdxEntry& a, const IdxEntry& b) {
+              return a.hash < b.hash || (a.hash == b.hash && a.pos < b.pos);
+            });
+
+  _idx.assign(sorted.size() + 1, IdxEntry{0, 0});
+  size_t i = 0;
+  fillIdx(sorted, &i, 1);
+
   _final = true;
 }
 
 // ____________________________________________________________________________
 template <typename T>
-bool ContContainer<T>::remove(const std::string& id) {
-  throw std::runtime_error(std::string("Can't remove ") + id +
+uint32_t ContContainer<T>::hash(std::string_view id) {
+  uint64_t h = std::hash<std::string_view>()(id);
+  return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void ContContainer<T>::fillIdx(const std::vector<IdxEntry>& sorted, size_t* i,
+                               size_t k) {
+  if (k >= _idx.size()) return;
+  fillIdx(sorted, i, 2 * k);
+  _idx[k] = sorted[(*i)++];
+  fillIdx(sorted, i, 2 * k + 1);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* ContContainer<T>::find(std::string_view id) const {
+  uint32_t h = hash(id);
+
+  auto range = _stagedIdx.equal_range(h);
+  for (auto i = range.first; i != range.second; ++i) {
+    if (_staged[i->second].getId() == id) return &_staged[i->second];
+  }
+
+  if (_idx.empty()) return 0;
+  size_t n = _idx.size() - 1;
+
+  // first entry with a hash >= h, 0 if there is none
+  size_t k = 1;
+  while (k <= n) k = 2 * k + (_idx[k].hash < h);
+  k >>= __builtin_ffsll(~k);
+
+  // entries with the same hash follow in order
+  while (k && _idx[k].hash == h) {
+    if (_vec[_idx[k].pos].getId() == id) return &_vec[_idx[k].pos];
+    if (2 * k + 1 <= n) {
+      k = 2 * k + 1;
+      while (2 * k <= n) k = 2 * k;
+    } else {
+      k >>= __builtin_ffsll(~k);
+    }
+  }
+
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool ContContainer<T>::remove(std::string_view id) {
+  throw std::runtime_error("Can't remove " + std::string(id) +
                            " from a continuous container.");
 }
 
 // ____________________________________________________________________________
 template <typename T>
-const T* ContContainer<T>::getRef(const std::string& id) const {
-  if (get(id)) return id;
+const T* ContContainer<T>::getRef(std::string_view id) const {
+  return get(id);
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* ContContainer<T>::getRef(std::string_view id) {
+  return get(id);
 }
 
 // ____________________________________________________________________________
 template <typename T>
-T* ContContainer<T>::getRef(const std::string& id) {
-  if (get(id)) return id;
+T* ContContainer<T>::get(std::string_view id) {
+  return const_cast<T*>(find(id));
 }
 
 // ____________________________________________________________________________
 template <typename T>
-T* ContContainer<T>::get(const std::string& id) {
-  if (!_final)
-    throw std::runtime_error(
-        "Cannot get from an unfinalized continuous container.");
-  auto cmp = ContCompCmp2<T>();
-  auto i = std::lower_bound(_vec.begin(), _vec.end(), id, cmp);
-  if (i == _vec.end()) return 0;
-  if (T::getId(&*i) != id) return 0;
-  return &*i;
+const T* ContContainer<T>::get(std::string_view id) const {
+  return find(id);
 }
 
 // ____________________________________________________________________________
 template <typename T>
-const T* ContContainer<T>::get(const std::string& id) const {
-  if (!_final)
-    throw std::runtime_error(
-        "Cannot get from an unfinalized continuous container.");
-  auto cmp = ContCompCmp2<T>();
-  auto i = std::lower_bound(_vec.begin(), _vec.end(), id, cmp);
-  if (i == _vec.end()) return 0;
-  if (T::getId(&*i) != id) return 0;
-  return &*i;
+bool ContContainer<T>::has(std::string_view id) const {
+  return get(id) != 0;
 }
 
 // ____________________________________________________________________________
 template <typename T>
 size_t ContContainer<T>::size() const {
-  return _vec.size();
+  return _vec.size() + _staged.size();
 }
 
 // ____________________________________________________________________________
@@ -6,35 +6,45 @@
 #define AD_CPPGTFS_GTFS_CONTAINER_H_
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace ad {
 namespace cppgtfs {
 namespace gtfs {
 
+// Owns the entities of one type, by id. Ids can be looked up as
+// string_view, without building a string for each lookup.
 template <typename T>
 class Container {
  public:
+  typedef std::unordered_map<std::string, T*> Map;
+
   Container(){};
   ~Container();
   T* add(const T& obj);
-  bool remove(const std::string& id);
-  const T* get(const std::string& id) const;
-  T* get(const std::string& id);
-  bool has(const std::string& id) const;
-  const T* getRef(const std::string& id) const { return get(id); }
-  T* getRef(const std::string& id) { return get(id); }
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const { return get(id); }
+  T* getRef(std::string_view id) { return get(id); }
   size_t size() const;
   void finalize() {};
 
-  typename std::unordered_map<std::string, T*>::const_iterator begin() const;
-  typename std::unordered_map<std::string, T*>::iterator begin();
+  typename Map::const_iterator begin() const;
+  typename Map::iterator begin();
 
-  typename std::unordered_map<std::string, T*>::const_iterator end() const;
-  typename std::unordered_map<std::string, T*>::iterator end();
+  typename Map::const_iterator end() const;
+  typename Map::iterator end();
 
  private:
-  std::unordered_map<std::string, T*> _map;
+  Map _map;
+
+  // Returns id as a string for a lookup in _map. The string is reused by all
+  // lookups of the calling thread, so it only allocates for ids longer than
+  // the ones looked up before.
+  static const std::string& key(std::string_view id);
 };
 
 #include <cppgtfs/gtfs/Container.tpp>
@@ -14,38 +14,37 @@ Container<T>::~Container() {
 template <typename T>
 T* Container<T>::add(const T& ent) {
   T* c = new T(ent);
-  if (_map.insert(std::pair<std::string, T*>(T::getId(c), c)).second) return c;
+  if (_map.emplace(T::getId(c), c).second) return c;
+  delete c;
   return 0;
 }
 
 // ____________________________________________________________________________
 template <typename T>
-bool Container<T>::remove(const std::string& id) {
-  return _map.erase(id);
+bool Container<T>::remove(std::string_view id) {
+  return _map.erase(key(id));
 }
 
 // ____________________________________________________________________________
 template <typename T>
-T* Container<T>::get(const std::string& id) {
-  if (_map.find(id) != _map.end()) {
-    return _map.find(id)->second;
-  }
+T* Container<T>::get(std::string_view id) {
+  auto i = _map.find(key(id));
+  if (i != _map.end()) return i->second;
   return 0;
 }
 
 // ____________________________________________________________________________
 template <typename T>
-const T* Container<T>::get(const std::string& id) const {
-  if (_map.find(id) != _map.end()) {
-    return _map.find(id)->second;
-  }
+const T* Container<T>::get(std::string_view id) const {
+  auto i = _map.find(key(id));
+  if (i != _map.end()) return i->second;
   return 0;
 }
 
 // ____________________________________________________________________________
 template <typename T>
-bool Container<T>::has(const std::string& id) const {
-  return (_map.find(id) != _map.end());
+bool Container<T>::has(std::string_view id) const {
+  return (_map.find(key(id)) != _map.end());
 }
 
 // ____________________________________________________________________________
@@ -56,26 +55,32 @@ size_t Container<T>::size() const {
 
 // ____________________________________________________________________________
 template <typename T>
-typename std::unordered_map<std::string, T*>::const_iterator
-Container<T>::begin() const {
+typename Container<T>::Map::const_iterator Container<T>::begin() const {
   return _map.begin();
 }
 
 // ____________________________________________________________________________
 template <typename T>
-typename std::unordered_map<std::string, T*>::iterator Container<T>::begin() {
+typename Container<T>::Map::iterator Container<T>::begin() {
   return _map.begin();
 }
 
 // ____________________________________________________________________________
 template <typename T>
-typename std::unordered_map<std::string, T*>::const_iterator Container<T>::end()
-    const {
+typename Container<T>::Map::const_iterator Container<T>::end() const {
   return _map.end();
 }
 
 // ____________________________________________________________________________
 template <typename T>
-typename std::unordered_map<std::string, T*>::iterator Container<T>::end() {
+typename Container<T>::Map::iterator Container<T>::end() {
   return _map.end();
 }
+
+// ____________________________________________________________________________
+template <typename T>
+const std::string& Container<T>::key(std::string_view id) {
+  static thread_local std::string k;
+  k.assign(id.data(), id.size());
+  return k;
+}
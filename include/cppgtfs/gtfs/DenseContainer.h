@@ -0,0 +1,70 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_DENSECONTAINER_H_
+#define AD_CPPGTFS_GTFS_DENSECONTAINER_H_
+
+#include <stdint.h>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Numbers its entities 0..size()-1 in the order they were added, so that
+// data about them can be kept in plain arrays indexed by indexOf(). The
+// entities do not move, pointers to them stay valid. To keep the numbering
+// dense, entities cannot be removed.
+template <typename T>
+class DenseContainer {
+ public:
+  typedef typename std::deque<T>::const_iterator const_iterator;
+  typedef typename std::deque<T>::iterator iterator;
+
+  // index of no entity
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  DenseContainer() {}
+
+  T* add(const T& obj);
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const { return get(id); }
+  T* getRef(std::string_view id) { return get(id); }
+  size_t size() const { return _vec.size(); }
+  void finalize() {};
+
+  const T& operator[](uint32_t idx) const { return _vec[idx]; }
+  T& operator[](uint32_t idx) { return _vec[idx]; }
+
+  // Returns the index of the entity with the given id, or NONE.
+  uint32_t indexOf(std::string_view id) const;
+
+  // Returns the index of the given entity of this container, or NONE.
+  uint32_t indexOf(const T* ref) const;
+
+  const_iterator begin() const { return _vec.begin(); }
+  iterator begin() { return _vec.begin(); }
+
+  const_iterator end() const { return _vec.end(); }
+  iterator end() { return _vec.end(); }
+
+ private:
+  std::deque<T> _vec;
+  std::unordered_map<std::string_view, uint32_t> _idx;
+};
+
+#include <cppgtfs/gtfs/DenseContainer.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_DENSECONTAINER_H_
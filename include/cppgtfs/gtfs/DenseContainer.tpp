@@ -0,0 +1,64 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename T>
+T* DenseContainer<T>::add(const T& ent) {
+  if (_vec.size() >= NONE) {
+    throw std::runtime_error("Too many entities for a dense container.");
+  }
+
+  _vec.push_back(ent);
+  T* c = &_vec.back();
+  if (_idx.emplace(T::getId(c), _vec.size() - 1).second) return c;
+
+  _vec.pop_back();
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool DenseContainer<T>::remove(std::string_view id) {
+  throw std::runtime_error("Can't remove " + std::string(id) +
+                           " from a dense container.");
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* DenseContainer<T>::get(std::string_view id) {
+  auto i = _idx.find(id);
+  if (i != _idx.end()) return &_vec[i->second];
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* DenseContainer<T>::get(std::string_view id) const {
+  auto i = _idx.find(id);
+  if (i != _idx.end()) return &_vec[i->second];
+  return 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool DenseContainer<T>::has(std::string_view id) const {
+  return (_idx.find(id) != _idx.end());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+uint32_t DenseContainer<T>::indexOf(std::string_view id) const {
+  auto i = _idx.find(id);
+  if (i != _idx.end()) return i->second;
+  return NONE;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+uint32_t DenseContainer<T>::indexOf(const T* ref) const {
+  if (!ref) return NONE;
+  uint32_t i = indexOf(ref->getId());
+  if (i != NONE && &_vec[i] == ref) return i;
+  return NONE;
+}
@@ -0,0 +1,103 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_DENSESTOPTIME_H_
+#define AD_CPPGTFS_GTFS_DENSESTOPTIME_H_
+
+#include <stdint.h>
+#include <string>
+#include <cppgtfs/gtfs/StopTime.h>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Stop time (as the StopTimeT of a feed) referring to its stop by the stop's
+// index in a DenseContainer, in 32 instead of 64 bits. The stop is resolved
+// with getStop(feed.getStops()), which is a plain array access.
+template <typename StopT>
+class DenseStopTime {
+ public:
+  typedef flat::StopTime::PU_DO_TYPE PU_DO_TYPE;
+
+  // what a stop time holds to refer to its stop
+  typedef uint32_t StopRef;
+
+  // what a stop time holds to refer to its headsign
+  typedef std::string HeadsignRef;
+
+  // Returns the StopRef of s, one of the stops in the DenseContainer stops.
+  template <typename StopsT>
+  static StopRef getStopRef(const StopsT& stops, typename StopT::Ref s) {
+    return stops.indexOf(s);
+  }
+
+  // Returns the HeadsignRef of hs, the headsign is held by the stop time.
+  static const HeadsignRef& getHeadsignRef(StringPool*, const std::string& hs) {
+    return hs;
+  }
+
+  DenseStopTime(const Time& at, const Time& dt, StopRef s, uint32_t seq,
+                const std::string& hs, PU_DO_TYPE put, PU_DO_TYPE dot,
+                float distTrav, bool isTp)
+      : _at(at),
+        _dt(dt),
+        _s(s),
+        _sequence(seq),
+        _headsign(hs),
+        _pickupType(put),
+        _dropOffType(dot),
+        _isTimepoint(isTp),
+        _shapeDistTravelled(distTrav) {}
+
+  const Time& getArrivalTime() const { return _at; }
+  const Time& getDepartureTime() const { return _dt; }
+
+  uint32_t getStopIndex() const { return _s; }
+  StopRef getStopRef() const { return _s; }
+  const HeadsignRef& getHeadsignRef() const { return _headsign; }
+
+  template <typename StopsT>
+  const StopT* getStop(const StopsT& stops) const {
+    return &stops[_s];
+  }
+
+  template <typename StopsT>
+  StopT* getStop(StopsT& stops) const {
+    return &stops[_s];
+  }
+
+  const std::string& getHeadsign() const { return _headsign; }
+
+  PU_DO_TYPE getPickupType() const {
+    return static_cast<PU_DO_TYPE>(_pickupType);
+  }
+
+  PU_DO_TYPE getDropOffType() const {
+    return static_cast<PU_DO_TYPE>(_dropOffType);
+  }
+
+  float getShapeDistanceTravelled() const { return _shapeDistTravelled; }
+  void setShapeDistanceTravelled(float d) { _shapeDistTravelled = d; }
+  bool isTimepoint() const { return _isTimepoint; }
+  uint32_t getSeq() const { return _sequence; }
+
+ private:
+  Time _at;
+  Time _dt;
+
+  uint32_t _s;
+  uint32_t _sequence;
+  std::string _headsign;
+  uint8_t _pickupType : 2;
+  uint8_t _dropOffType : 2;
+  bool _isTimepoint : 1;
+  float _shapeDistTravelled;
+};
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_DENSESTOPTIME_H_
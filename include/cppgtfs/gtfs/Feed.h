@@ -7,17 +7,25 @@
 
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <cppgtfs/gtfs/Agency.h>
+#include <cppgtfs/gtfs/ArenaContainer.h>
+#include <cppgtfs/gtfs/CompactStopTime.h>
+#include <cppgtfs/gtfs/ConcurrentContainer.h>
 #include <cppgtfs/gtfs/ContContainer.h>
 #include <cppgtfs/gtfs/Container.h>
+#include <cppgtfs/gtfs/DenseContainer.h>
+#include <cppgtfs/gtfs/DenseStopTime.h>
 #include <cppgtfs/gtfs/Fare.h>
+#include <cppgtfs/gtfs/FlatContainer.h>
 #include <cppgtfs/gtfs/Route.h>
 #include <cppgtfs/gtfs/Service.h>
 #include <cppgtfs/gtfs/Shape.h>
 #include <cppgtfs/gtfs/Stop.h>
+#include <cppgtfs/gtfs/StringPool.h>
 #include <cppgtfs/gtfs/Transfer.h>
 #include <cppgtfs/gtfs/Trip.h>
 
@@ -86,6 +94,11 @@ class FeedB {
   const Fares& getFares() const;
   Fares& getFares();
 
+  // strings the stop times refer to instead of holding them (see
+  // CompactStopTime), freed with the feed
+  const StringPool& getStringPool() const;
+  StringPool& getStringPool();
+
   const std::string& getPublisherName() const;
   const std::string& getPublisherUrl() const;
   const std::string& getLang() const;
@@ -110,6 +123,9 @@ class FeedB {
   void setPath(const std::string& p) { _path = p; }
 
  private:
+  // first, so that it is freed after the stop times
+  StringPool _strings;
+
   Agencies _agencies;
   Stops _stops;
   Routes _routes;
@@ -122,6 +138,9 @@ class FeedB {
 
   double _maxLat, _maxLon, _minLat, _minLon;
 
+  // tables updating the box may be parsed concurrently
+  std::mutex _boxMutex;
+
   std::string _publisherName, _publisherUrl, _lang, _version, _path;
   ServiceDate _startDate, _endDate;
 };
@@ -133,6 +152,27 @@ typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare,
               ContContainer, ContContainer, ContContainer, ContContainer,
               ContContainer, ContContainer, ContContainer>
     ContFeed;
+typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare,
+              ArenaContainer, ArenaContainer, ArenaContainer, ArenaContainer,
+              ArenaContainer, ArenaContainer, ArenaContainer>
+    ArenaFeed;
+typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare,
+              FlatContainer, FlatContainer, FlatContainer, FlatContainer,
+              FlatContainer, FlatContainer, FlatContainer>
+    FlatFeed;
+typedef FeedB<Agency, Route, Stop, Service, DenseStopTime, Shape, Fare,
+              DenseContainer, DenseContainer, DenseContainer, DenseContainer,
+              DenseContainer, DenseContainer, DenseContainer>
+    DenseFeed;
+typedef FeedB<Agency, Route, Stop, Service, StopTime, Shape, Fare,
+              ConcurrentContainer, ConcurrentContainer, ConcurrentContainer,
+              ConcurrentContainer, ConcurrentContainer, ConcurrentContainer,
+              ConcurrentContainer>
+    ConcurrentFeed;
+typedef FeedB<Agency, Route, Stop, Service, CompactStopTime, Shape, Fare,
+              Container, Container, Container, Container, Container, Container,
+              Container>
+    CompactFeed;
 
 #include <cppgtfs/gtfs/Feed.tpp>
 
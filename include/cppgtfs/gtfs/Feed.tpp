@@ -76,6 +76,14 @@ const typename FEEDB::Fares& FEEDB::getFares() const { return _fares; }
 FEEDTPL
 typename FEEDB::Fares& FEEDB::getFares() { return _fares; }
 
+// ____________________________________________________________________________
+FEEDTPL
+const StringPool& FEEDB::getStringPool() const { return _strings; }
+
+// ____________________________________________________________________________
+FEEDTPL
+StringPool& FEEDB::getStringPool() { return _strings; }
+
 // ____________________________________________________________________________
 FEEDTPL
 const std::string& FEEDB::getPublisherName() const { return _publisherName; }
@@ -127,6 +135,7 @@ void FEEDB::setEndDate(const ServiceDate& end) { _endDate = end; }
 // ____________________________________________________________________________
 FEEDTPL
 void FEEDB::updateBox(double lat, double lon) {
+  std::lock_guard<std::mutex> lock(_boxMutex);
   if (lat > _maxLat) _maxLat = lat;
   if (lon > _maxLon) _maxLon = lon;
   if (lat < _minLat) _minLat = lat;
@@ -0,0 +1,110 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_FLATCONTAINER_H_
+#define AD_CPPGTFS_GTFS_FLATCONTAINER_H_
+
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Like Container, but the entities are indexed by an open-addressing hash
+// table with linear probing. The table is a single array of (id, entity,
+// hash) slots, so a lookup touches one or two cache lines instead of a
+// chain of nodes. Ids can be looked up as any string_view without building
+// a std::string. Removed entities are freed.
+template <typename T>
+class FlatContainer {
+ public:
+  typedef std::pair<std::string_view, T*> value_type;
+
+ private:
+  struct Slot {
+    // kv.second is 0 for free slots
+    value_type kv;
+    size_t hash;
+  };
+
+ public:
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef FlatContainer::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef const value_type& reference;
+
+    const_iterator() : _cur(0), _end(0) {}
+    const_iterator(const Slot* cur, const Slot* end) : _cur(cur), _end(end) {
+      skip();
+    }
+
+    reference operator*() const { return _cur->kv; }
+    pointer operator->() const { return &_cur->kv; }
+    const_iterator& operator++() {
+      _cur++;
+      skip();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator r = *this;
+      ++*this;
+      return r;
+    }
+    bool operator==(const const_iterator& o) const { return _cur == o._cur; }
+    bool operator!=(const const_iterator& o) const { return _cur != o._cur; }
+
+   private:
+    const Slot* _cur;
+    const Slot* _end;
+
+    void skip() {
+      while (_cur != _end && !_cur->kv.second) _cur++;
+    }
+  };
+  typedef const_iterator iterator;
+
+  FlatContainer() : _size(0) {}
+  FlatContainer(const FlatContainer&) = delete;
+  FlatContainer& operator=(const FlatContainer&) = delete;
+  ~FlatContainer();
+
+  T* add(const T& obj);
+  bool remove(std::string_view id);
+  const T* get(std::string_view id) const;
+  T* get(std::string_view id);
+  bool has(std::string_view id) const;
+  const T* getRef(std::string_view id) const { return get(id); }
+  T* getRef(std::string_view id) { return get(id); }
+  size_t size() const { return _size; }
+  void finalize() {};
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+ private:
+  std::vector<Slot> _slots;
+  size_t _size;
+
+  // Returns the slot holding id, or the free slot where it would go.
+  size_t find(std::string_view id, size_t hash) const;
+
+  // Doubles the number of slots.
+  void grow();
+};
+
+#include <cppgtfs/gtfs/FlatContainer.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_FLATCONTAINER_H_
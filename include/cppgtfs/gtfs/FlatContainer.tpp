@@ -0,0 +1,118 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename T>
+FlatContainer<T>::~FlatContainer() {
+  for (const auto& s : _slots) delete s.kv.second;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+size_t FlatContainer<T>::find(std::string_view id, size_t hash) const {
+  size_t mask = _slots.size() - 1;
+  size_t i = hash & mask;
+  while (_slots[i].kv.second &&
+         (_slots[i].hash != hash || _slots[i].kv.first != id)) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+void FlatContainer<T>::grow() {
+  std::vector<Slot> old(_slots.empty() ? 16 : _slots.size() * 2);
+  old.swap(_slots);
+
+  size_t mask = _slots.size() - 1;
+  for (const auto& s : old) {
+    if (!s.kv.second) continue;
+    size_t i = s.hash & mask;
+    while (_slots[i].kv.second) i = (i + 1) & mask;
+    _slots[i] = s;
+  }
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* FlatContainer<T>::add(const T& ent) {
+  // keep the load factor below 3/4
+  if ((_size + 1) * 4 > _slots.size() * 3) grow();
+
+  T* c = new T(ent);
+  std::string_view id = T::getId(c);
+  size_t hash = std::hash<std::string_view>()(id);
+
+  size_t i = find(id, hash);
+  if (_slots[i].kv.second) {
+    delete c;
+    return 0;
+  }
+
+  _slots[i] = Slot{value_type(id, c), hash};
+  _size++;
+  return c;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool FlatContainer<T>::remove(std::string_view id) {
+  if (_slots.empty()) return false;
+  size_t i = find(id, std::hash<std::string_view>()(id));
+  if (!_slots[i].kv.second) return false;
+
+  delete _slots[i].kv.second;
+  _size--;
+
+  // shift back the following entries which would not be found anymore
+  // across the gap
+  size_t mask = _slots.size() - 1;
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask;
+    if (!_slots[j].kv.second) break;
+    size_t home = _slots[j].hash & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      _slots[i] = _slots[j];
+      i = j;
+    }
+  }
+
+  _slots[i] = Slot();
+  return true;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+T* FlatContainer<T>::get(std::string_view id) {
+  if (_slots.empty()) return 0;
+  return _slots[find(id, std::hash<std::string_view>()(id))].kv.second;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+const T* FlatContainer<T>::get(std::string_view id) const {
+  if (_slots.empty()) return 0;
+  return _slots[find(id, std::hash<std::string_view>()(id))].kv.second;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+bool FlatContainer<T>::has(std::string_view id) const {
+  return get(id) != 0;
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename FlatContainer<T>::const_iterator FlatContainer<T>::begin() const {
+  return const_iterator(_slots.data(), _slots.data() + _slots.size());
+}
+
+// ____________________________________________________________________________
+template <typename T>
+typename FlatContainer<T>::const_iterator FlatContainer<T>::end() const {
+  const Slot* e = _slots.data() + _slots.size();
+  return const_iterator(e, e);
+}
@@ -0,0 +1,104 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_LAZY_H_
+#define AD_CPPGTFS_GTFS_LAZY_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// A value which is filled by a loader on the first access. Concurrent first
+// accesses load it only once. If the loader throws, the exception is passed
+// on to the caller and the next access tries again. A copy has a value of
+// its own: it is a copy of the loaded value, or it is loaded by the same
+// loader on its own first access.
+template <typename T>
+class Lazy {
+ public:
+  typedef std::function<void(T* value)> Loader;
+
+  Lazy() {}
+  explicit Lazy(Loader load) : _state(new State()) { _state->load = load; }
+
+  Lazy(const Lazy& other) { copy(other); }
+
+  Lazy& operator=(const Lazy& other) {
+    if (this != &other) copy(other);
+    return *this;
+  }
+
+  Lazy(Lazy&& other) = default;
+  Lazy& operator=(Lazy&& other) = default;
+
+  // Returns true iff a loader was set.
+  bool isSet() const { return _state != 0; }
+
+  const T& get() const {
+    load();
+    return _state->value;
+  }
+
+  T& get() {
+    load();
+    return _state->value;
+  }
+
+ private:
+  struct State {
+    State() : loaded(false) {}
+
+    std::atomic<bool> loaded;
+    std::mutex m;
+    Loader load;
+    T value;
+  };
+
+  std::unique_ptr<State> _state;
+
+  void load() const {
+    State* s = _state.get();
+    if (s->loaded.load(std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lock(s->m);
+    if (s->loaded.load(std::memory_order_relaxed)) return;
+
+    T v;
+    s->load(&v);
+    s->value = std::move(v);
+    s->load = Loader();
+    s->loaded.store(true, std::memory_order_release);
+  }
+
+  void copy(const Lazy& other) {
+    if (!other._state) {
+      _state.reset();
+      return;
+    }
+
+    std::unique_ptr<State> s(new State());
+    {
+      std::lock_guard<std::mutex> lock(other._state->m);
+      if (other._state->loaded.load(std::memory_order_relaxed)) {
+        s->value = other._state->value;
+        s->loaded.store(true, std::memory_order_relaxed);
+      } else {
+        s->load = other._state->load;
+      }
+    }
+    _state = std::move(s);
+  }
+};
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_LAZY_H_
@@ -6,6 +6,7 @@
 #define AD_CPPGTFS_GTFS_NULLCONTAINER_H_
 
 #include <string>
+#include <string_view>
 
 namespace ad {
 namespace cppgtfs {
@@ -16,8 +17,8 @@ class NullContainer {
  public:
   NullContainer(){}
   std::string add(const T& obj) const {return obj.getId();}
-  T* get(const std::string& id) const {do { (void)(id); } while (0); return 0;}
-  std::string getRef(const std::string& id) const {return id;}
+  T* get(std::string_view id) const {do { (void)(id); } while (0); return 0;}
+  std::string getRef(std::string_view id) const {return std::string(id);}
   void finalize() {};
 };
 
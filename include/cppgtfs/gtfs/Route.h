@@ -25,7 +25,7 @@ template <typename AgencyT>
 class RouteB {
  public:
   typedef RouteB<AgencyT>* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
 
   typedef flat::Route::TYPE TYPE;
 
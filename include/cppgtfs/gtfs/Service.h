@@ -24,7 +24,7 @@ typedef flat::ServiceDate ServiceDate;
 class Service {
  public:
   typedef Service* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
 
   typedef flat::Calendar::SERVICE_DAY SERVICE_DAY;
   typedef flat::CalendarDate::EXCEPTION_TYPE EXCEPTION_TYPE;
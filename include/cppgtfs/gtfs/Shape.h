@@ -5,9 +5,15 @@
 #ifndef AD_CPPGTFS_GTFS_SHAPE_H_
 #define AD_CPPGTFS_GTFS_SHAPE_H_
 
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 #include <set>
 #include <string>
 #include <vector>
+#include <cppgtfs/gtfs/Lazy.h>
 
 using std::exception;
 using std::string;
@@ -33,32 +39,382 @@ struct ShapePointCompare {
 
 typedef std::vector<ShapePoint> ShapePoints;
 
+// Shape points with increasing sequence numbers, stored in a fraction of
+// the space of ShapePoints. The coordinates and distances are stored as
+// fixed-point numbers with as many decimal digits per shape as needed to
+// give back the exact floats, each point as the differences to the previous
+// one, as variable-length integers. If the sequence numbers increase by a
+// constant step, they are not stored at all. Points whose values cannot be
+// given back exactly with up to MAX_DIGITS digits are stored as plain
+// floats. The encoding is lossless.
+class ShapePolyline {
+ public:
+  // decimal digits kept at most
+  static constexpr uint8_t MAX_DIGITS = 9;
+
+  // Decodes the points one by one.
+  class Reader {
+   public:
+    explicit Reader(const ShapePolyline& l)
+        : _l(l), _cur(l._data.data()), _end(l._data.data() + l._data.size()),
+          _i(0), _seq(0), _lat(0), _lng(0), _dist(0) {}
+
+    // Writes the next point to p, returns false if there is none.
+    bool next(ShapePoint* p) {
+      if (_cur == _end) return false;
+
+      if (_l._seqStep) {
+        _seq = _l._seqFirst + _i * _l._seqStep;
+      } else {
+        _seq += get();
+      }
+      _i++;
+
+      uint64_t v = get();
+      if (v == RAW) {
+        float lat = getRaw(), lng = getRaw(), dist = getRaw();
+        *p = ShapePoint(lat, lng, dist, _seq);
+        return true;
+      }
+
+      _lat += unzigzag(v >> 1);
+      _lng += unzigzag(get());
+      _dist += unzigzag(get());
+      *p = ShapePoint(fromFixed(_lat, _l._coordDigits),
+                      fromFixed(_lng, _l._coordDigits),
+                      fromFixed(_dist, _l._distDigits), _seq);
+      return true;
+    }
+
+   private:
+    const ShapePolyline& _l;
+    const uint8_t* _cur;
+    const uint8_t* _end;
+    uint32_t _i, _seq;
+    int64_t _lat, _lng, _dist;
+
+    uint64_t get() {
+      uint64_t v = 0;
+      for (int shift = 0;; shift += 7) {
+        uint8_t b = *_cur++;
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+      }
+    }
+
+    float getRaw() {
+      uint32_t b = 0;
+      for (size_t i = 0; i < 4; i++) {
+        b |= static_cast<uint32_t>(*_cur++) << (8 * i);
+      }
+      float f;
+      std::memcpy(&f, &b, sizeof(f));
+      return f;
+    }
+  };
+
+  ShapePolyline() { clear(); }
+
+  size_t size() const { return _n; }
+  bool empty() const { return _n == 0; }
+
+  // The last point, only valid if not empty().
+  const ShapePoint& back() const { return _last; }
+
+  // Appends p, whose sequence number has to be larger than that of back().
+  // If p needs more digits than the points before, or breaks the constant
+  // step of their sequence numbers, the points are encoded again.
+  void push_back(const ShapePoint& p) {
+    // whether p breaks the constant step of the sequence numbers
+    bool unsteady = _seqStep && _n > 0 &&
+                    (p.seq == _last.seq ||
+                     (_n > 1 && p.seq - _last.seq != _seqStep));
+    bool stepped = _seqStep && !unsteady;
+
+    uint8_t coordDigits = std::max(digitsFor(p.lat, _coordDigits),
+                                   digitsFor(p.lng, _coordDigits));
+    uint8_t distDigits = digitsFor(p.travelDist, _distDigits);
+
+    if (unsteady || coordDigits != _coordDigits || distDigits != _distDigits) {
+      ShapePoints pts = decode();
+      clear();
+      _coordDigits = coordDigits;
+      _distDigits = distDigits;
+      if (!stepped) _seqStep = 0;
+      for (const auto& pt : pts) append(pt);
+    }
+
+    append(p);
+  }
+
+  ShapePoints decode() const {
+    ShapePoints ret;
+    ret.reserve(_n);
+    ShapePoint p;
+    Reader r(*this);
+    while (r.next(&p)) ret.push_back(p);
+    return ret;
+  }
+
+  void clear() {
+    std::vector<uint8_t>().swap(_data);
+    _n = 0;
+    _last = ShapePoint();
+    _coordDigits = 0;
+    _distDigits = 0;
+    _seqFirst = 0;
+    _seqStep = 1;
+    _lat = _lng = _dist = 0;
+  }
+
+  // Frees the unused capacity.
+  void shrink() { _data.shrink_to_fit(); }
+
+ private:
+  // first value of a point stored as plain floats, other points start with
+  // an even value
+  static constexpr uint64_t RAW = 1;
+
+  std::vector<uint8_t> _data;
+  uint32_t _n;
+  ShapePoint _last;
+
+  // decimal digits of the coordinates and of the distances
+  uint8_t _coordDigits;
+  uint8_t _distDigits;
+
+  // if not 0, the sequence numbers are _seqFirst, _seqFirst + _seqStep, ...
+  // and are not stored
+  uint32_t _seqFirst;
+  uint32_t _seqStep;
+
+  // fixed-point values of the last point not stored as plain floats
+  int64_t _lat, _lng, _dist;
+
+  // Appends p with the current number of digits and sequence mode.
+  void append(const ShapePoint& p) {
+    if (_seqStep) {
+      if (_n == 0) _seqFirst = p.seq;
+      if (_n == 1) _seqStep = p.seq - _last.seq;
+    } else {
+      put(p.seq - _last.seq);
+    }
+
+    int64_t lat, lng, dist;
+    if (toFixed(p.lat, _coordDigits, &lat) &&
+        toFixed(p.lng, _coordDigits, &lng) &&
+        toFixed(p.travelDist, _distDigits, &dist)) {
+      put(zigzag(lat - _lat) << 1);
+      put(zigzag(lng - _lng));
+      put(zigzag(dist - _dist));
+      _lat = lat;
+      _lng = lng;
+      _dist = dist;
+    } else {
+      put(RAW);
+      putRaw(p.lat);
+      putRaw(p.lng);
+      putRaw(p.travelDist);
+    }
+
+    _last = p;
+    _n++;
+  }
+
+  void put(uint64_t v) {
+    while (v >= 0x80) {
+      _data.push_back(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    _data.push_back(static_cast<uint8_t>(v));
+  }
+
+  void putRaw(float f) {
+    uint32_t b;
+    std::memcpy(&b, &f, sizeof(b));
+    for (size_t i = 0; i < 4; i++) {
+      _data.push_back(static_cast<uint8_t>(b >> (8 * i)));
+    }
+  }
+
+  static double pow10(uint8_t digits) {
+    static const double p[] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                               1e5, 1e6, 1e7, 1e8, 1e9};
+    return p[digits];
+  }
+
+  static float fromFixed(int64_t q, uint8_t digits) {
+    return static_cast<float>(static_cast<double>(q) / pow10(digits));
+  }
+
+  // Sets *q to f with the given number of decimal digits. Returns false if
+  // fromFixed() does not give back the exact f (bit by bit) from it.
+  static bool toFixed(float f, uint8_t digits, int64_t* q) {
+    if (!std::isfinite(f)) return false;
+    double v = static_cast<double>(f) * pow10(digits);
+    if (std::fabs(v) >= 4503599627370496.0) return false;  // 2^52
+    *q = std::llround(v);
+    float back = fromFixed(*q, digits);
+    return std::memcmp(&back, &f, sizeof(f)) == 0;
+  }
+
+  // Returns the least number of digits, from digits on, with which f can be
+  // given back exactly. Returns digits if there is none.
+  static uint8_t digitsFor(float f, uint8_t digits) {
+    int64_t q;
+    for (uint8_t d = digits; d <= MAX_DIGITS; d++) {
+      if (toFixed(f, d, &q)) return d;
+    }
+    return digits;
+  }
+
+  // maps small negative and positive differences to small values
+  static uint64_t zigzag(int64_t d) {
+    return (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+  }
+
+  static int64_t unzigzag(uint64_t z) {
+    return static_cast<int64_t>((z >> 1) ^ (0 - (z & 1)));
+  }
+};
+
 class Shape {
  public:
   typedef Shape* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
   Shape() {}
 
   explicit Shape(const string& id) : _id(id) {}
 
   const std::string& getId() const { return _id; }
 
-  const ShapePoints& getPoints() const { return _shapePoints; }
+  // The points are stored encoded (see ShapePolyline) and decoded on each
+  // call. To go over them without building a vector, use getPolyline().
+  ShapePoints getPoints() const {
+    if (!_unsorted.empty()) return sorted();
+    return polyline().decode();
+  }
+
+  // Only valid while no points wait for sortPoints(), which the parser
+  // calls for all shapes.
+  const ShapePolyline& getPolyline() const {
+    assert(_unsorted.empty());
+    return polyline();
+  }
 
+  size_t getNumPoints() const {
+    if (!_unsorted.empty()) return _unsorted.size();
+    return polyline().size();
+  }
+
+  // Replaces the points by ones filled by load on the first access to them
+  // (see Lazy). Copies of the shape have points of their own.
+  void setPointLoader(Lazy<ShapePoints>::Loader load) {
+    _points.clear();
+    ShapePoints().swap(_unsorted);
+    _lazyPoints = Lazy<ShapePolyline>([load](ShapePolyline* l) {
+      ShapePoints pts;
+      load(&pts);
+      for (const auto& p : pts) l->push_back(p);
+      l->shrink();
+    });
+  }
+
+  // Adds p, returns false if the point added before has the same
+  // shape_pt_sequence. A point which does not come after the points before
+  // waits for sortPoints() like the points of appendPoints(), which also
+  // finds the collisions among these.
   bool addPoint(const ShapePoint& p) {
-    for (size_t i = 0; i < _shapePoints.size(); i++) {
-      if (_shapePoints[i].seq == p.seq) return false;
+    const ShapePolyline& l = polyline();
+    if (!_unsorted.empty()) {
+      if (_unsorted.back().seq == p.seq) return false;
+    } else if (!l.empty() && l.back().seq == p.seq) {
+      return false;
+    }
+    appendPoints(ShapePoints{p});
+    return true;
+  }
+
+  // Bulk loading: appends the points without sorting or checking for
+  // shape_pt_sequence collisions. Returns false if they do not come in
+  // increasing order after the existing points, sortPoints() has to be
+  // called before the points are used in this case.
+  bool appendPoints(const ShapePoints& add) {
+    if (add.empty()) return _unsorted.empty();
+    ShapePolyline& l = polyline();
+
+    bool inOrder =
+        _unsorted.empty() && (l.empty() || l.back().seq < add.front().seq) &&
+        std::adjacent_find(add.begin(), add.end(),
+                           [](const ShapePoint& a, const ShapePoint& b) {
+                             return a.seq >= b.seq;
+                           }) == add.end();
+
+    if (inOrder) {
+      for (const auto& p : add) l.push_back(p);
+      return true;
     }
-    _shapePoints.reserve(_shapePoints.size() + 1);
-    _shapePoints.push_back(p);
+
+    // collect the points decoded until they are sorted
+    if (_unsorted.empty()) {
+      _unsorted = l.decode();
+      l.clear();
+    }
+    _unsorted.insert(_unsorted.end(), add.begin(), add.end());
+    return false;
+  }
+
+  // Sorts the points by shape_pt_sequence (a no-op if they already are), and
+  // frees the unused capacity left by appendPoints(). Returns false if a
+  // shape_pt_sequence occurs more than once, the points then stay pending.
+  bool sortPoints() {
+    if (_unsorted.empty()) {
+      polyline().shrink();
+      return true;
+    }
+
     auto cmp = ShapePointCompare();
-    std::sort(_shapePoints.begin(), _shapePoints.end(), cmp);
+    std::sort(_unsorted.begin(), _unsorted.end(), cmp);
+    for (size_t i = 1; i < _unsorted.size(); i++) {
+      if (_unsorted[i - 1].seq == _unsorted[i].seq) return false;
+    }
+
+    encode(_unsorted);
+    ShapePoints().swap(_unsorted);
     return true;
   }
 
  private:
   string _id;
-  ShapePoints _shapePoints;
+  ShapePolyline _points;
+  Lazy<ShapePolyline> _lazyPoints;
+
+  // while bulk loading, points which came out of order
+  ShapePoints _unsorted;
+
+  // Returns a copy of _unsorted sorted by shape_pt_sequence.
+  ShapePoints sorted() const {
+    ShapePoints pts = _unsorted;
+    std::stable_sort(pts.begin(), pts.end(), ShapePointCompare());
+    return pts;
+  }
+
+  const ShapePolyline& polyline() const {
+    if (_lazyPoints.isSet()) return _lazyPoints.get();
+    return _points;
+  }
+
+  ShapePolyline& polyline() {
+    if (_lazyPoints.isSet()) return _lazyPoints.get();
+    return _points;
+  }
+
+  void encode(const ShapePoints& pts) {
+    ShapePolyline& l = polyline();
+    l.clear();
+    for (const auto& p : pts) l.push_back(p);
+    l.shrink();
+  }
 };
 
 }  // namespace gtfs
@@ -20,7 +20,7 @@ namespace gtfs {
 class Stop {
  public:
   typedef Stop* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
   typedef flat::Stop::LOCATION_TYPE LOCATION_TYPE;
   typedef flat::Stop::WHEELCHAIR_BOARDING WHEELCHAIR_BOARDING;
 
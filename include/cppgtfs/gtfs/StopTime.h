@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <cppgtfs/gtfs/Stop.h>
+#include <cppgtfs/gtfs/StringPool.h>
 #include <cppgtfs/gtfs/flat/StopTime.h>
 
 using std::exception;
@@ -26,6 +27,23 @@ class StopTime {
  public:
   typedef flat::StopTime::PU_DO_TYPE PU_DO_TYPE;
 
+  // what a stop time holds to refer to its stop
+  typedef typename StopT::Ref StopRef;
+
+  // what a stop time holds to refer to its headsign
+  typedef std::string HeadsignRef;
+
+  // Returns the StopRef of s, one of the stops of a feed.
+  template <typename StopsT>
+  static StopRef getStopRef(const StopsT&, typename StopT::Ref s) {
+    return s;
+  }
+
+  // Returns the HeadsignRef of hs, the headsign is held by the stop time.
+  static const HeadsignRef& getHeadsignRef(StringPool*, const std::string& hs) {
+    return hs;
+  }
+
   StopTime(const Time& at, const Time& dt, typename StopT::Ref s, uint32_t seq,
            const std::string& hs, PU_DO_TYPE put, PU_DO_TYPE dot,
            float distTrav, bool isTp)
@@ -44,6 +62,8 @@ class StopTime {
 
   const typename StopT::Ref getStop() const { return _s; }
   typename StopT::Ref getStop() { return _s; }
+  StopRef getStopRef() const { return _s; }
+  const HeadsignRef& getHeadsignRef() const { return _headsign; }
   const std::string& getHeadsign() const { return _headsign; }
 
   PU_DO_TYPE getPickupType() const {
@@ -0,0 +1,143 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_STOPTIMECOLUMNS_H_
+#define AD_CPPGTFS_GTFS_STOPTIMECOLUMNS_H_
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cppgtfs/gtfs/StopTime.h>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Column store for the stop times of many trips. Each column is one array
+// over all stop times, the stop times of a trip are the rows in its range.
+// Scans over single columns (for example, all departures) are sequential,
+// and a row takes 25 bytes instead of the about 64 bytes (plus the
+// headsign) of a StopTime. Stops are numbered in the order they are first
+// seen, headsigns are stored once per distinct value.
+//
+// Filled from parsed trips with add(), which can also release the trip's
+// own stop times, or while parsing by Parser::parse(feed, path, cols), so
+// that the stop times of the whole feed are never held as StopTime objects.
+template <typename TripT, typename StopT>
+class StopTimeColumns {
+ public:
+  typedef typename TripT::StopTimes::value_type StopTimeT;
+  typedef typename StopTimeT::PU_DO_TYPE PU_DO_TYPE;
+
+  // what the stop times refer to their stop by, the stop's index in the
+  // feed's stops for a DenseStopTime
+  typedef typename StopTimeT::StopRef StopRef;
+
+  // what the stop times refer to their headsign by, a reference into the
+  // feed's StringPool for a CompactStopTime
+  typedef typename StopTimeT::HeadsignRef HeadsignRef;
+
+  // rows [begin, end)
+  struct Range {
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  // arrival and departure time of empty times
+  static constexpr int32_t NO_TIME = -1;
+
+  StopTimeColumns();
+
+  // Appends the stop times of trip as a new range. If release is true, the
+  // trip's stop times are freed afterwards. Throws a std::runtime_error if
+  // the trip was already added.
+  void add(TripT* trip, bool release);
+
+  // Appends sts as the range of trip, they have to be sorted by
+  // stop_sequence. Throws a std::runtime_error if the trip was already
+  // added.
+  void add(TripT* trip, const typename TripT::StopTimes& sts);
+
+  // Removes the ranges of the given trips, the following rows move up. The
+  // stops and headsigns only used by them keep their indices.
+  void remove(const std::unordered_set<const TripT*>& trips);
+
+  bool has(const TripT* trip) const { return _ranges.count(trip); }
+
+  // Returns the range of the given trip, an empty range if it was not
+  // added.
+  Range getRange(const TripT* trip) const;
+
+  // the added trips in the order of their ranges
+  const std::vector<TripT*>& getTrips() const { return _trips; }
+
+  size_t size() const { return _at.size(); }
+
+  // times in seconds since midnight, or NO_TIME
+  const std::vector<int32_t>& getArrivalTimes() const { return _at; }
+  const std::vector<int32_t>& getDepartureTimes() const { return _dt; }
+
+  // indices into getStops()
+  const std::vector<uint32_t>& getStopIndices() const { return _stop; }
+  const std::vector<uint32_t>& getSequences() const { return _seq; }
+  const std::vector<float>& getShapeDistances() const { return _dist; }
+
+  // pickup type in bits 0-1, drop off type in bits 2-3, timepoint in bit 4
+  const std::vector<uint8_t>& getFlags() const { return _flags; }
+
+  // indices into getHeadsigns(), 0 is the empty headsign
+  const std::vector<uint32_t>& getHeadsignIndices() const { return _hs; }
+
+  const std::vector<StopRef>& getStops() const { return _stops; }
+  const std::vector<HeadsignRef>& getHeadsigns() const { return _headsigns; }
+
+  PU_DO_TYPE getPickupType(size_t row) const {
+    return static_cast<PU_DO_TYPE>(_flags[row] & 3);
+  }
+  PU_DO_TYPE getDropOffType(size_t row) const {
+    return static_cast<PU_DO_TYPE>((_flags[row] >> 2) & 3);
+  }
+  bool isTimepoint(size_t row) const { return _flags[row] & 16; }
+
+  // Returns the given row as a stop time.
+  StopTimeT getStopTime(size_t row) const;
+
+  // Returns the rows of the given trip as stop times.
+  typename TripT::StopTimes getStopTimes(const TripT* trip) const;
+
+  // Frees the unused capacity of the columns.
+  void shrink();
+
+ private:
+  std::vector<int32_t> _at;
+  std::vector<int32_t> _dt;
+  std::vector<uint32_t> _stop;
+  std::vector<uint32_t> _seq;
+  std::vector<float> _dist;
+  std::vector<uint8_t> _flags;
+  std::vector<uint32_t> _hs;
+
+  std::vector<StopRef> _stops;
+  std::unordered_map<StopRef, uint32_t> _stopIdx;
+
+  std::vector<HeadsignRef> _headsigns;
+  std::unordered_map<HeadsignRef, uint32_t> _headsignIdx;
+
+  std::vector<TripT*> _trips;
+  std::unordered_map<const TripT*, Range> _ranges;
+
+  static int32_t toSeconds(const Time& t);
+  static Time fromSeconds(int32_t s);
+};
+
+#include <cppgtfs/gtfs/StopTimeColumns.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_STOPTIMECOLUMNS_H_
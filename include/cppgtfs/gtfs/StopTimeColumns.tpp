@@ -0,0 +1,163 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+StopTimeColumns<TripT, StopT>::StopTimeColumns() {
+  _headsigns.push_back(HeadsignRef());
+  _headsignIdx[HeadsignRef()] = 0;
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+int32_t StopTimeColumns<TripT, StopT>::toSeconds(const Time& t) {
+  if (t.empty()) return NO_TIME;
+  return t.seconds();
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+Time StopTimeColumns<TripT, StopT>::fromSeconds(int32_t s) {
+  if (s == NO_TIME) return Time();
+  return Time(s / 3600, (s / 60) % 60, s % 60);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+void StopTimeColumns<TripT, StopT>::add(TripT* trip, bool release) {
+  auto& sts = trip->getStopTimes();
+  add(trip, sts);
+  if (release) typename TripT::StopTimes().swap(sts);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+void StopTimeColumns<TripT, StopT>::add(TripT* trip,
+                                        const typename TripT::StopTimes& sts) {
+  if (_ranges.count(trip)) {
+    throw std::runtime_error("Trip " + trip->getId() +
+                             " was already added to the columns.");
+  }
+
+  if (_at.size() + sts.size() > UINT32_MAX) {
+    throw std::runtime_error("Too many stop times for the columns.");
+  }
+
+  Range r{static_cast<uint32_t>(_at.size()), 0};
+
+  for (const auto& st : sts) {
+    _at.push_back(toSeconds(st.getArrivalTime()));
+    _dt.push_back(toSeconds(st.getDepartureTime()));
+    _seq.push_back(st.getSeq());
+    _dist.push_back(st.getShapeDistanceTravelled());
+    _flags.push_back(st.getPickupType() | (st.getDropOffType() << 2) |
+                     (st.isTimepoint() << 4));
+
+    // try_emplace() only builds a node (and copies the headsign) for new keys
+    auto s = _stopIdx.try_emplace(st.getStopRef(), _stops.size());
+    if (s.second) _stops.push_back(st.getStopRef());
+    _stop.push_back(s.first->second);
+
+    auto h = _headsignIdx.try_emplace(st.getHeadsignRef(), _headsigns.size());
+    if (h.second) _headsigns.push_back(st.getHeadsignRef());
+    _hs.push_back(h.first->second);
+  }
+
+  r.end = _at.size();
+  _ranges[trip] = r;
+  _trips.push_back(trip);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+void StopTimeColumns<TripT, StopT>::remove(
+    const std::unordered_set<const TripT*>& trips) {
+  if (trips.empty()) return;
+
+  // the ranges follow each other in the order of _trips, the kept ones are
+  // moved up in one pass
+  size_t w = 0;
+  std::vector<TripT*> kept;
+
+  for (auto trip : _trips) {
+    auto i = _ranges.find(trip);
+    Range r = i->second;
+
+    if (trips.count(trip)) {
+      _ranges.erase(i);
+      continue;
+    }
+
+    if (w != r.begin) {
+      for (size_t row = r.begin; row < r.end; row++) {
+        size_t to = w + row - r.begin;
+        _at[to] = _at[row];
+        _dt[to] = _dt[row];
+        _stop[to] = _stop[row];
+        _seq[to] = _seq[row];
+        _dist[to] = _dist[row];
+        _flags[to] = _flags[row];
+        _hs[to] = _hs[row];
+      }
+    }
+
+    i->second = Range{static_cast<uint32_t>(w),
+                      static_cast<uint32_t>(w + r.end - r.begin)};
+    w += r.end - r.begin;
+    kept.push_back(trip);
+  }
+
+  _at.resize(w);
+  _dt.resize(w);
+  _stop.resize(w);
+  _seq.resize(w);
+  _dist.resize(w);
+  _flags.resize(w);
+  _hs.resize(w);
+  _trips.swap(kept);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+typename StopTimeColumns<TripT, StopT>::Range
+StopTimeColumns<TripT, StopT>::getRange(const TripT* trip) const {
+  auto i = _ranges.find(trip);
+  if (i == _ranges.end()) return Range{0, 0};
+  return i->second;
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+typename StopTimeColumns<TripT, StopT>::StopTimeT
+StopTimeColumns<TripT, StopT>::getStopTime(size_t row) const {
+  return StopTimeT(fromSeconds(_at[row]), fromSeconds(_dt[row]),
+                   _stops[_stop[row]], _seq[row], _headsigns[_hs[row]],
+                   getPickupType(row), getDropOffType(row), _dist[row],
+                   isTimepoint(row));
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+typename TripT::StopTimes StopTimeColumns<TripT, StopT>::getStopTimes(
+    const TripT* trip) const {
+  typename TripT::StopTimes ret;
+  Range r = getRange(trip);
+  ret.reserve(r.end - r.begin);
+  for (size_t row = r.begin; row < r.end; row++) {
+    ret.push_back(getStopTime(row));
+  }
+  return ret;
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+void StopTimeColumns<TripT, StopT>::shrink() {
+  _at.shrink_to_fit();
+  _dt.shrink_to_fit();
+  _stop.shrink_to_fit();
+  _seq.shrink_to_fit();
+  _dist.shrink_to_fit();
+  _flags.shrink_to_fit();
+  _hs.shrink_to_fit();
+}
@@ -0,0 +1,165 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_STRINGPOOL_H_
+#define AD_CPPGTFS_GTFS_STRINGPOOL_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Pool of distinct strings, numbered from 1 in the order they are first
+// added. 0 is the empty string. Strings are never removed, they are freed
+// with the pool. Safe to use from several threads: add() locks, at() does
+// not, as the strings are kept in blocks which never move once allocated.
+//
+// A pool gets an id with its first string, under which get() finds it, so
+// that a string can be referred to by a Ref of 6 bytes instead of a
+// pointer. At most MAX_POOLS - 1 pools with strings can exist at a time.
+class StringPool {
+ public:
+  static constexpr size_t MAX_POOLS = size_t(1) << 16;
+
+  // a string of a pool, {0, 0} is the empty string
+  struct Ref {
+    uint16_t pool = 0;
+    uint32_t i = 0;
+
+    bool operator==(const Ref& o) const { return pool == o.pool && i == o.i; }
+    bool operator!=(const Ref& o) const { return !(*this == o); }
+  };
+
+  StringPool() : _id(0), _size(0) {
+    for (auto& b : _blocks) b.store(0);
+  }
+
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  ~StringPool() {
+    if (_id) {
+      std::lock_guard<std::mutex> lock(registryMutex());
+      registry()[_id].store(0, std::memory_order_relaxed);
+    }
+    for (auto& b : _blocks) delete[] b.load();
+  }
+
+  uint32_t add(const std::string& s) {
+    if (s.empty()) return 0;
+    std::lock_guard<std::mutex> lock(_m);
+    auto i = _idx.find(s);
+    if (i != _idx.end()) return i->second;
+    if (_size == UINT32_MAX) {
+      throw std::runtime_error("Too many distinct strings in the pool.");
+    }
+    if (!_id) enroll();
+
+    size_t b, o;
+    locate(_size, &b, &o);
+    std::string* blk = _blocks[b].load(std::memory_order_relaxed);
+    if (!blk) {
+      blk = new std::string[FIRST << b];
+      _blocks[b].store(blk, std::memory_order_release);
+    }
+
+    blk[o] = s;
+    _idx.emplace(blk[o], ++_size);
+    return _size;
+  }
+
+  // Adds s, returns it as a Ref.
+  Ref ref(const std::string& s) {
+    uint32_t i = add(s);
+    if (!i) return Ref();
+    return Ref{_id, i};
+  }
+
+  // i has to be returned by an add() which happened before.
+  const std::string& at(uint32_t i) const {
+    if (i == 0) return empty();
+    size_t b, o;
+    locate(i - 1, &b, &o);
+    return _blocks[b].load(std::memory_order_acquire)[o];
+  }
+
+  // r has to be returned by a ref() of a pool which still exists.
+  static const std::string& get(Ref r) {
+    if (r.i == 0) return empty();
+    return registry()[r.pool].load(std::memory_order_acquire)->at(r.i);
+  }
+
+ private:
+  // the first block holds FIRST strings, each further one twice as many as
+  // the one before, enough blocks for UINT32_MAX strings
+  static constexpr size_t FIRST_BITS = 10;
+  static constexpr size_t FIRST = size_t(1) << FIRST_BITS;
+  static constexpr size_t BLOCKS = 23;
+
+  // Sets b and o to the block and the offset in it of the n-th string.
+  static void locate(size_t n, size_t* b, size_t* o) {
+    size_t v = n + FIRST;
+    *b = (63 - __builtin_clzll(v)) - FIRST_BITS;
+    *o = v - (FIRST << *b);
+  }
+
+  static const std::string& empty() {
+    static const std::string e;
+    return e;
+  }
+
+  // the pools with an id, by their id, slot 0 is never used
+  static std::atomic<StringPool*>* registry() {
+    static std::atomic<StringPool*> pools[MAX_POOLS];
+    return pools;
+  }
+
+  static std::mutex& registryMutex() {
+    static std::mutex m;
+    return m;
+  }
+
+  // Gives the pool the lowest free id, has to be called under _m.
+  void enroll() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto pools = registry();
+    for (size_t id = 1; id < MAX_POOLS; id++) {
+      if (!pools[id].load(std::memory_order_relaxed)) {
+        pools[id].store(this, std::memory_order_release);
+        _id = id;
+        return;
+      }
+    }
+    throw std::runtime_error("Too many string pools.");
+  }
+
+  std::mutex _m;
+  std::atomic<std::string*> _blocks[BLOCKS];
+  uint16_t _id;
+  uint32_t _size;
+  std::unordered_map<std::string_view, uint32_t> _idx;
+};
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+namespace std {
+template <>
+struct hash<ad::cppgtfs::gtfs::StringPool::Ref> {
+  size_t operator()(const ad::cppgtfs::gtfs::StringPool::Ref& r) const {
+    return (static_cast<size_t>(r.pool) << 32) | r.i;
+  }
+};
+}  // namespace std
+
+#endif  // AD_CPPGTFS_GTFS_STRINGPOOL_H_
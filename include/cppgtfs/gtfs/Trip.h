@@ -10,6 +10,7 @@
 #include <set>
 #include <string>
 #include <cppgtfs/gtfs/Frequency.h>
+#include <cppgtfs/gtfs/Lazy.h>
 #include <cppgtfs/gtfs/Route.h>
 #include <cppgtfs/gtfs/Service.h>
 #include <cppgtfs/gtfs/Shape.h>
@@ -27,13 +28,13 @@ namespace gtfs {
 template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 class TripB {
+ public:
   // typedef std::set<StopTimeT, StopTimeCompare<StopTimeT>> StopTimes;
   typedef std::vector<StopTimeT> StopTimes;
   typedef std::vector<Frequency> Frequencies;
 
- public:
   typedef TripB<StopTimeT, ServiceT, RouteT, ShapeT>* Ref;
-  static std::string getId(Ref r) { return r->getId(); }
+  static const std::string& getId(Ref r) { return r->getId(); }
 
   typedef flat::Trip::WC_BIKE_ACCESSIBLE WC_BIKE_ACCESSIBLE;
   typedef flat::Trip::DIRECTION DIRECTION;
@@ -65,6 +66,20 @@ class TripB {
   bool addStopTime(const StopTimeT& t);
   void addFrequency(const Frequency& t);
 
+  // Bulk loading: appends the stop time without sorting or checking for
+  // stop_sequence collisions. Returns false if it does not come after the
+  // previous stop time, sortStopTimes() has to be called before the stop
+  // times are used in this case.
+  bool appendStopTime(const StopTimeT& t);
+
+  // Sorts the stop times by stop_sequence (a no-op if they already are).
+  // Returns false if a stop_sequence occurs more than once.
+  bool sortStopTimes();
+
+  // Replaces the stop times by ones filled by load on the first access to
+  // them (see Lazy). Copies of the trip have stop times of their own.
+  void setStopTimeLoader(typename Lazy<StopTimes>::Loader load);
+
   gtfs::flat::Trip getFlat() const {
     return gtfs::flat::Trip{
         _id,       RouteT::getId(_route), ServiceT::getId(_service),
@@ -86,6 +101,7 @@ class TripB {
   WC_BIKE_ACCESSIBLE _ba;
 
   StopTimes _stoptimes;
+  Lazy<StopTimes> _lazyStoptimes;
   Frequencies _frequencies;
 };
 
@@ -135,6 +135,7 @@ template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 const typename TripB<StopTimeT, ServiceT, RouteT, ShapeT>::StopTimes&
 TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getStopTimes() const {
+  if (_lazyStoptimes.isSet()) return _lazyStoptimes.get();
   return _stoptimes;
 }
 
@@ -143,6 +144,7 @@ template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 typename TripB<StopTimeT, ServiceT, RouteT, ShapeT>::StopTimes&
 TripB<StopTimeT, ServiceT, RouteT, ShapeT>::getStopTimes() {
+  if (_lazyStoptimes.isSet()) return _lazyStoptimes.get();
   return _stoptimes;
 }
 
@@ -167,13 +169,44 @@ template <typename StopTimeT, typename ServiceT, typename RouteT,
           typename ShapeT>
 bool TripB<StopTimeT, ServiceT, RouteT, ShapeT>::addStopTime(
     const StopTimeT& t) {
-  for (size_t i = 0; i < _stoptimes.size(); i++) {
-    if (_stoptimes[i].getSeq() == t.getSeq()) return false;
+  StopTimes& sts = getStopTimes();
+  if (sts.empty() || sts.back().getSeq() < t.getSeq()) {
+    sts.push_back(t);
+    return true;
   }
-  _stoptimes.reserve(_stoptimes.size() + 1);
-  _stoptimes.push_back(t);
+
+  auto cmp = StopTimeCompare<StopTimeT>();
+  auto i = std::lower_bound(sts.begin(), sts.end(), t, cmp);
+  if (i != sts.end() && i->getSeq() == t.getSeq()) return false;
+  sts.insert(i, t);
+  return true;
+}
+
+// _____________________________________________________________________________
+template <typename StopTimeT, typename ServiceT, typename RouteT,
+          typename ShapeT>
+bool TripB<StopTimeT, ServiceT, RouteT, ShapeT>::appendStopTime(
+    const StopTimeT& t) {
+  StopTimes& sts = getStopTimes();
+  bool inOrder =
+      sts.empty() || sts.back().getSeq() < t.getSeq();
+  sts.push_back(t);
+  return inOrder;
+}
+
+// _____________________________________________________________________________
+template <typename StopTimeT, typename ServiceT, typename RouteT,
+          typename ShapeT>
+bool TripB<StopTimeT, ServiceT, RouteT, ShapeT>::sortStopTimes() {
+  StopTimes& sts = getStopTimes();
   auto cmp = StopTimeCompare<StopTimeT>();
-  std::sort(_stoptimes.begin(), _stoptimes.end(), cmp);
+  if (!std::is_sorted(sts.begin(), sts.end(), cmp)) {
+    std::sort(sts.begin(), sts.end(), cmp);
+  }
+
+  for (size_t i = 1; i < sts.size(); i++) {
+    if (sts[i - 1].getSeq() == sts[i].getSeq()) return false;
+  }
   return true;
 }
 
@@ -184,3 +217,12 @@ void TripB<StopTimeT, ServiceT, RouteT, ShapeT>::addFrequency(
     const Frequency& t) {
   _frequencies.push_back(t);
 }
+
+// _____________________________________________________________________________
+template <typename StopTimeT, typename ServiceT, typename RouteT,
+          typename ShapeT>
+void TripB<StopTimeT, ServiceT, RouteT, ShapeT>::setStopTimeLoader(
+    typename Lazy<StopTimes>::Loader load) {
+  _stoptimes.clear();
+  _lazyStoptimes = Lazy<StopTimes>(load);
+}
@@ -0,0 +1,160 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_TRIPPATTERNS_H_
+#define AD_CPPGTFS_GTFS_TRIPPATTERNS_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cppgtfs/gtfs/StopTime.h>
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+
+// Groups trips into patterns: trips whose stop times differ only in their
+// arrival and departure times. Each pattern stores its stops (with sequence
+// number, headsign, pickup / drop off type, timepoint flag and distance)
+// once. The times of a trip are stored as a timing profile, relative to the
+// trip's first time, and the trip's start. Trips of a pattern which only
+// differ in their start (like trips running every 10 minutes) share their
+// profile.
+//
+// Filled from parsed trips with add(), which can also release the trip's
+// own stop times. Released stop times are rebuilt from the pattern when
+// they are accessed again.
+template <typename TripT, typename StopT>
+class TripPatterns {
+ public:
+  typedef typename TripT::StopTimes::value_type StopTimeT;
+  typedef typename StopTimeT::PU_DO_TYPE PU_DO_TYPE;
+
+  // what the stop times refer to their stop by, the stop's index in the
+  // feed's stops for a DenseStopTime
+  typedef typename StopTimeT::StopRef StopRef;
+
+  // what the stop times refer to their headsign by, a reference into the
+  // feed's StringPool for a CompactStopTime
+  typedef typename StopTimeT::HeadsignRef HeadsignRef;
+
+  // arrival and departure time of empty times, a time relative to the
+  // start of a trip cannot be this small
+  static constexpr int32_t NO_TIME = INT32_MIN;
+
+  // a stop time without its times
+  struct PatternStop {
+    StopRef stop;
+    uint32_t seq;
+    HeadsignRef headsign;
+    PU_DO_TYPE pickupType;
+    PU_DO_TYPE dropOffType;
+    bool isTimepoint;
+    float shapeDistTravelled;
+
+    bool operator==(const PatternStop& o) const {
+      return stop == o.stop && seq == o.seq && headsign == o.headsign &&
+             pickupType == o.pickupType && dropOffType == o.dropOffType &&
+             isTimepoint == o.isTimepoint &&
+             shapeDistTravelled == o.shapeDistTravelled;
+    }
+  };
+
+  class Pattern {
+   public:
+    const std::vector<PatternStop>& getStops() const { return _stops; }
+    const std::vector<TripT*>& getTrips() const { return _trips; }
+
+    // times in seconds since midnight of the i-th stop of the t-th trip, or
+    // NO_TIME
+    int32_t getArrival(size_t t, size_t i) const {
+      return shift(_profiles[2 * (_profile[t] * _stops.size() + i)], t);
+    }
+    int32_t getDeparture(size_t t, size_t i) const {
+      return shift(_profiles[2 * (_profile[t] * _stops.size() + i) + 1], t);
+    }
+
+    // the first time of the t-th trip, in seconds since midnight
+    int32_t getStart(size_t t) const { return _start[t]; }
+
+    // the number of the timing profile of the t-th trip
+    uint32_t getProfile(size_t t) const { return _profile[t]; }
+
+    size_t getNumProfiles() const {
+      return _stops.empty() ? 0 : _profiles.size() / (2 * _stops.size());
+    }
+
+    // Returns the i-th stop time of the t-th trip.
+    StopTimeT getStopTime(size_t t, size_t i) const;
+
+   private:
+    friend class TripPatterns;
+
+    std::vector<PatternStop> _stops;
+    std::vector<TripT*> _trips;
+
+    // arrival and departure per stop relative to the start, profile by
+    // profile
+    std::vector<int32_t> _profiles;
+
+    // profiles by the hash of their times
+    std::unordered_multimap<size_t, uint32_t> _byHash;
+
+    // profile and start per trip
+    std::vector<uint32_t> _profile;
+    std::vector<int32_t> _start;
+
+    int32_t shift(int32_t time, size_t t) const {
+      return time == NO_TIME ? NO_TIME : time + _start[t];
+    }
+
+    // Returns the number of the profile with the given times, adds it if
+    // there is none.
+    uint32_t addProfile(const std::vector<int32_t>& times);
+  };
+
+  TripPatterns() {}
+
+  // released trips refer to the patterns they were added to
+  TripPatterns(const TripPatterns&) = delete;
+  TripPatterns& operator=(const TripPatterns&) = delete;
+
+  // Adds trip to the pattern of its stop times. If release is true, the
+  // trip's stop times are freed afterwards, and rebuilt from the pattern
+  // on the first access to them (see Lazy), which keeps them in the trip
+  // again. These patterns have to exist as long as such a trip. Throws a
+  // std::runtime_error if the trip was already added.
+  void add(TripT* trip, bool release);
+
+  const std::vector<Pattern>& getPatterns() const { return _patterns; }
+  size_t size() const { return _patterns.size(); }
+
+  // Returns the pattern of trip and the trip's position in it, or 0 if the
+  // trip was not added.
+  const Pattern* getPattern(const TripT* trip, size_t* pos) const;
+
+ private:
+  std::vector<Pattern> _patterns;
+
+  // patterns by the hash of their stops
+  std::unordered_multimap<size_t, uint32_t> _byHash;
+
+  // pattern and position of each trip
+  std::unordered_map<const TripT*, std::pair<uint32_t, uint32_t>> _trips;
+
+  static size_t hash(const std::vector<PatternStop>& stops);
+  static int32_t toSeconds(const Time& t);
+  static Time fromSeconds(int32_t s);
+};
+
+#include <cppgtfs/gtfs/TripPatterns.tpp>
+
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_TRIPPATTERNS_H_
@@ -0,0 +1,145 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+int32_t TripPatterns<TripT, StopT>::toSeconds(const Time& t) {
+  if (t.empty()) return NO_TIME;
+  return t.seconds();
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+Time TripPatterns<TripT, StopT>::fromSeconds(int32_t s) {
+  if (s == NO_TIME) return Time();
+  return Time(s / 3600, (s / 60) % 60, s % 60);
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+size_t TripPatterns<TripT, StopT>::hash(const std::vector<PatternStop>& stops) {
+  size_t h = stops.size();
+  for (const auto& s : stops) {
+    size_t v = std::hash<StopRef>()(s.stop) ^
+               (std::hash<HeadsignRef>()(s.headsign) << 1) ^
+               (static_cast<size_t>(s.seq) << 8) ^
+               (s.pickupType | (s.dropOffType << 2) | (s.isTimepoint << 4));
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+void TripPatterns<TripT, StopT>::add(TripT* trip, bool release) {
+  if (_trips.count(trip)) {
+    throw std::runtime_error("Trip " + trip->getId() +
+                             " was already added to the patterns.");
+  }
+
+  auto& sts = trip->getStopTimes();
+
+  std::vector<PatternStop> stops;
+  stops.reserve(sts.size());
+  for (const auto& st : sts) {
+    stops.push_back(PatternStop{
+        st.getStopRef(), st.getSeq(), st.getHeadsignRef(), st.getPickupType(),
+        st.getDropOffType(), st.isTimepoint(),
+        st.getShapeDistanceTravelled()});
+  }
+
+  size_t h = hash(stops);
+  uint32_t p = _patterns.size();
+  auto range = _byHash.equal_range(h);
+  for (auto i = range.first; i != range.second; ++i) {
+    if (_patterns[i->second]._stops == stops) {
+      p = i->second;
+      break;
+    }
+  }
+
+  if (p == _patterns.size()) {
+    _patterns.push_back(Pattern());
+    _patterns.back()._stops.swap(stops);
+    _byHash.emplace(h, p);
+  }
+
+  std::vector<int32_t> times;
+  times.reserve(2 * sts.size());
+  for (const auto& st : sts) {
+    times.push_back(toSeconds(st.getArrivalTime()));
+    times.push_back(toSeconds(st.getDepartureTime()));
+  }
+
+  // the profile is relative to the first time of the trip
+  int32_t start = 0;
+  for (auto t : times) {
+    if (t != NO_TIME) {
+      start = t;
+      break;
+    }
+  }
+  for (auto& t : times) {
+    if (t != NO_TIME) t -= start;
+  }
+
+  Pattern& pat = _patterns[p];
+  _trips[trip] = std::make_pair(p, static_cast<uint32_t>(pat._trips.size()));
+  pat._trips.push_back(trip);
+  pat._profile.push_back(pat.addProfile(times));
+  pat._start.push_back(start);
+
+  if (release) {
+    uint32_t t = pat._trips.size() - 1;
+    trip->setStopTimeLoader([this, p, t](typename TripT::StopTimes* sts) {
+      const Pattern& pat = _patterns[p];
+      sts->reserve(pat._stops.size());
+      for (size_t i = 0; i < pat._stops.size(); i++) {
+        sts->push_back(pat.getStopTime(t, i));
+      }
+    });
+  }
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+uint32_t TripPatterns<TripT, StopT>::Pattern::addProfile(
+    const std::vector<int32_t>& times) {
+  size_t h = times.size();
+  for (auto t : times) h ^= t + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+
+  auto range = _byHash.equal_range(h);
+  for (auto i = range.first; i != range.second; ++i) {
+    if (std::equal(times.begin(), times.end(),
+                   _profiles.begin() + i->second * times.size())) {
+      return i->second;
+    }
+  }
+
+  uint32_t p = getNumProfiles();
+  _profiles.insert(_profiles.end(), times.begin(), times.end());
+  _byHash.emplace(h, p);
+  return p;
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+const typename TripPatterns<TripT, StopT>::Pattern*
+TripPatterns<TripT, StopT>::getPattern(const TripT* trip, size_t* pos) const {
+  auto i = _trips.find(trip);
+  if (i == _trips.end()) return 0;
+  if (pos) *pos = i->second.second;
+  return &_patterns[i->second.first];
+}
+
+// ____________________________________________________________________________
+template <typename TripT, typename StopT>
+typename TripPatterns<TripT, StopT>::StopTimeT
+TripPatterns<TripT, StopT>::Pattern::getStopTime(size_t t, size_t i) const {
+  const PatternStop& s = _stops[i];
+  return StopTimeT(fromSeconds(getArrival(t, i)),
+                   fromSeconds(getDeparture(t, i)), s.stop, s.seq, s.headsign,
+                   s.pickupType, s.dropOffType, s.shapeDistTravelled,
+                   s.isTimepoint);
+}
@@ -5,6 +5,7 @@
 #ifndef AD_CPPGTFS_GTFS_FLAT_ROUTE_H_
 #define AD_CPPGTFS_GTFS_FLAT_ROUTE_H_
 
+#include <set>
 #include <sstream>
 #include <string>
 #include <iomanip>
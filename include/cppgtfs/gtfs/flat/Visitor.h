@@ -0,0 +1,47 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_CPPGTFS_GTFS_FLAT_VISITOR_H_
+#define AD_CPPGTFS_GTFS_FLAT_VISITOR_H_
+
+#include <functional>
+#include "StopTime.h"
+#include "Agency.h"
+#include "Fare.h"
+#include "Frequency.h"
+#include "Route.h"
+#include "Service.h"
+#include "Shape.h"
+#include "Transfer.h"
+#include "Trip.h"
+
+namespace ad {
+namespace cppgtfs {
+namespace gtfs {
+namespace flat {
+
+// Callbacks for streaming the records of a feed with
+// Parser::parse(const std::string&, const Visitor&). Tables without a
+// callback are not read. The records are only valid during the call.
+struct Visitor {
+  std::function<void(const Agency&)> agency;
+  std::function<void(const Stop&)> stop;
+  std::function<void(const Route&)> route;
+  std::function<void(const Calendar&)> calendar;
+  std::function<void(const CalendarDate&)> calendarDate;
+  std::function<void(const ShapePoint&)> shapePoint;
+  std::function<void(const Trip&)> trip;
+  std::function<void(const StopTime&)> stopTime;
+  std::function<void(const Frequency&)> frequency;
+  std::function<void(const Transfer&)> transfer;
+  std::function<void(const Fare&)> fare;
+  std::function<void(const FareRule&)> fareRule;
+};
+
+}  // namespace flat
+}  // namespace gtfs
+}  // namespace cppgtfs
+}  // namespace ad
+
+#endif  // AD_CPPGTFS_GTFS_FLAT_VISITOR_H_
@@ -0,0 +1,76 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_UTIL_CSVINDEX_H_
+#define AD_UTIL_CSVINDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cppgtfs/util/CsvParser.h"
+
+/**
+ * Index of the records of a memory-mapped CSV file by the value of one of
+ * its fields (for example, trip_id in stop_times.txt). Each value is mapped
+ * to the byte ranges of the runs of consecutive records with that value, so
+ * that these records can be read with
+ * CsvParser(begin, stop, end, hdr) without scanning the file.
+ *
+ * The index can be stored in a sidecar file and read again later. The
+ * sidecar records the size and modification time of the indexed file, and
+ * is ignored if the file has changed since.
+ */
+namespace ad {
+namespace util {
+
+class CsvIndex {
+ public:
+  struct Range {
+    // byte offsets of the records in the file, records starting in
+    // [begin, stop) belong to the range
+    uint64_t begin;
+    uint64_t stop;
+
+    // the line the first record starts at
+    uint64_t line;
+  };
+
+  typedef std::vector<Range> Ranges;
+
+  CsvIndex() {}
+
+  // Indexes the records not yet read by csvp by the given field. The input
+  // of csvp has to be a memory-mapped file (see CsvParser::getInput()).
+  // Throws a CsvParserException otherwise, or if a record is malformed.
+  CsvIndex(CsvParser* csvp, const std::string& field);
+
+  // Returns the ranges of the records with the given value, or 0 if there
+  // are none.
+  const Ranges* get(const std::string& key) const;
+
+  const std::unordered_map<std::string, Ranges>& getRanges() const {
+    return _ranges;
+  }
+
+  const std::string& getField() const { return _field; }
+
+  // Writes the index of the file at filePath to the sidecar file at path.
+  // Throws a std::runtime_error if it cannot be written.
+  void write(const std::string& path, const std::string& filePath) const;
+
+  // Reads the index of the file at filePath by the given field from the
+  // sidecar file at path. Returns false if there is no such sidecar, if it
+  // is not readable, or if it does not match the current file or field.
+  bool read(const std::string& path, const std::string& filePath,
+            const std::string& field);
+
+ private:
+  std::string _field;
+  std::unordered_map<std::string, Ranges> _ranges;
+};
+}  // namespace util
+}  // namespace ad
+
+#endif  // AD_UTIL_CSVINDEX_H_
@@ -10,8 +10,10 @@
 #include <exception>
 #include <iostream>
 #include <istream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -65,11 +67,47 @@ class CsvParser {
   // Initializes the parser by opening the file and reading the table header.
   explicit CsvParser(std::istream* stream);
 
-  // Returns true iff same function of underlying stream returns true.
+  // Same as above, but the parser takes ownership of the stream. An empty
+  // pointer yields a parser that is not open.
+  explicit CsvParser(std::unique_ptr<std::istream> stream);
+
+  // Initializes the parser on the file at the given path and reads the table
+  // header. Regular files are memory-mapped and tokenized in place, without
+  // copying lines out of the mapped region. Other files (pipes, devices) are
+  // read in chunks.
+  explicit CsvParser(const std::string& path);
+
+  // Initializes the parser on in-memory input holding the records of a table
+  // whose header was already read by hdr. Only records starting in
+  // [begin, stop) are read, the last of them may extend up to end. begin has
+  // to be the start of a record. Line numbers continue those of hdr, as if
+  // begin directly followed the input consumed by hdr.
+  CsvParser(const char* begin, const char* stop, const char* end,
+            const CsvParser& hdr);
+
+  ~CsvParser();
+
+  CsvParser(const CsvParser&) = delete;
+  CsvParser& operator=(const CsvParser&) = delete;
+
+  // Returns true iff the underlying input could be opened.
+  bool isOpen() const;
+
+  // Returns true iff the whole input has been consumed.
   bool eof() const;
 
-  // Read next line.
-  // Returns true iff the line was read successfully.
+  // Returns true iff the rest of the input is available in memory (for
+  // example, a memory-mapped file). In this case, the part of it not yet
+  // consumed is [*begin, *end).
+  bool getRemaining(const char** begin, const char** end) const;
+
+  // Returns true iff the input is a memory-mapped file. In this case, the
+  // whole file is [*begin, *end).
+  bool getInput(const char** begin, const char** end) const;
+
+  // Read next record. Records are lines, but a quoted field may contain
+  // line breaks, see http://tools.ietf.org/html/rfc4180#page-2
+  // Returns true iff the record was read successfully.
   bool readNextLine();
 
   // Getters for i-th column from current line. Prerequisite: i < _numColumns.
@@ -78,6 +116,12 @@ class CsvParser {
   // returns the i-th column as a trimmed string
   const char* getTString(const size_t i) const;
 
+  // returns the i-th column as a trimmed string view. The view points
+  // directly into the input buffer (or the mapped file) and is only valid
+  // until the next call to readNextLine(). Unlike getTString(), this never
+  // copies the field.
+  std::string_view getTStringView(const size_t i) const;
+
   // returns the i-th column as a double
   double getDouble(const size_t i) const;
 
@@ -89,11 +133,13 @@ class CsvParser {
   // columns are accessed by their identifier.
   const char* getTString(const std::string& fieldName) const;
 
+  std::string_view getTStringView(const std::string& fieldName) const;
+
   double getDouble(const std::string& fieldName) const;
 
   int32_t getLong(const std::string& fieldName) const;
 
-  // returns the line number the parser is currently at
+  // returns the line number the current record starts at
   int32_t getCurLine() const;
 
   // checks whether a column with a specific name exists in this file
@@ -114,35 +160,114 @@ class CsvParser {
   const string getFieldName(size_t i) const;
 
  private:
+  // Bitmasks of the characters ending an unquoted field (delimiters and
+  // newlines) and a quoted field (quotes and newlines) in the 64-byte block
+  // of the input starting at base. Bit i is set iff base[i] is such a
+  // character.
+  struct Block {
+    const char* base;
+    uint64_t fieldEnds;
+    uint64_t quoteEnds;
+  };
+
   int32_t _curLine;
 
+  // number of lines consumed so far
+  int32_t _linesRead;
+
   // The handle to the file.
   std::istream* _stream;
 
+  // Stream owned by this parser, if any.
+  std::unique_ptr<std::istream> _ownStream;
+
+  // File descriptor opened by this parser for non-regular files given by
+  // path, or -1.
+  int _fd;
+
+  // The memory-mapped input file, if any.
+  const char* _map;
+  size_t _mapSize;
+
+  // The part of the input that is available, but not yet consumed. Points
+  // into the mapped file or into _buf.
+  const char* _pos;
+  const char* _end;
+
+  // Chunk buffer for input that is not memory-mapped. Grows if a single
+  // record does not fit into it.
+  std::vector<char> _buf;
+
+  // true iff no more input can be read into the buffer
+  bool _eof;
+
+  // if set, records starting at or after this position are not read
+  const char* _stop;
+
+  bool _open;
+
+  // The current block masks, and the (SIMD) function computing them.
+  Block _blk;
+  void (*_scanBlock)(const char* p, uint64_t* fieldEnds, uint64_t* quoteEnds);
+
   // Parses the header row and fills the header map.
   void parseHeader();
 
-  // returns a trimmed version of a const char*
-  //
-  // careful: this function is not idempotent. it will leave t
-  // right-trimmed.
-  const char* inlineRightTrim(const char* t) const;
+  // Maps the regular file at the given path into memory. Returns false if
+  // the file could not be mapped.
+  bool mapFile(const std::string& path);
+
+  // Moves the unconsumed input to the front of the chunk buffer and appends
+  // the next chunk read from the input. Returns false if nothing changed.
+  bool refill();
+
+  // Splits the record starting at line into the items of the current line.
+  // The record ends at the first newline outside of quotes or at end.
+  // Returns the position of this newline, or end. The number of newlines
+  // inside quoted fields is added to lines. unterminated is set to true if
+  // a quoted field is still open at end.
+  const char* tokenize(const char* line, const char* end, size_t* lines,
+                       bool* unterminated);
+
+  // Returns the first position in [pos, end) flagged in the given block mask,
+  // or end if there is none.
+  const char* findNext(const char* pos, const char* end,
+                       uint64_t Block::*mask);
+
+  // Computes the block masks for the 64 bytes starting at pos. Bytes at or
+  // after end are never flagged.
+  void loadBlock(const char* pos, const char* end);
+
+  // Pushes the item [s, s + len) to the current line, right-trimmed.
+  void pushItem(const char* s, size_t len);
+
+  // Pushes the quoted item [s, s + len) with its quote escapes ("") removed.
+  void pushEscapedItem(const char* s, size_t len);
+
+  // Builds null-terminated copies of the items of the current line for
+  // getTString().
+  void buildCStrings() const;
 
   // Map of field names to column indices. Parsed from the
   // table header (first row in a CSV file).
   std::unordered_map<std::string, size_t> _headerMap;
   std::vector<std::string> _headerVec;
 
-  // Pointers to the items in the current line.
-  std::vector<const char*> _currentItems;
+  // Views on the items in the current line.
+  std::vector<std::string_view> _currentItems;
 
-  // modified, quote-escaped strings
-  std::vector<std::string> _currentModItems;
+  // modified, quote-escaped strings, and the indices of the items pointing
+  // into them
+  std::string _modBuf;
+  std::vector<std::pair<size_t, size_t>> _modItems;
 
-  char _buff[10000] = {0};
+  // null-terminated copies of the current items, built on demand
+  mutable std::string _cStrBuf;
+  mutable std::vector<const char*> _cStrItems;
+  mutable bool _cStrValid;
 
-  static double atof(const char* p, uint8_t mn, bool* fail);
-  static uint32_t atoi(const char* p, bool* fail);
+  static double atof(const char* p, const char* end, uint8_t mn, bool* fail);
+  static uint32_t atoi(const char* p, const char* end, bool* fail);
 };
 }  // namespace util
 }  // namespace ad
@@ -0,0 +1,85 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef AD_UTIL_ZIPARCHIVE_H_
+#define AD_UTIL_ZIPARCHIVE_H_
+
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * A read-only ZIP archive. Reads the central directory of the archive and
+ * provides streams on the uncompressed content of its members, which are
+ * inflated on the fly. Stored and deflated members as well as ZIP64
+ * archives are supported.
+ */
+namespace ad {
+namespace util {
+
+class ZipEntryBuf;
+
+class ZipException : public std::exception {
+ public:
+  explicit ZipException(std::string msg) : _msg(msg) {}
+  ~ZipException() throw() {}
+
+  virtual const char* what() const throw() { return _msg.c_str(); }
+
+ private:
+  std::string _msg;
+};
+
+class ZipArchive {
+ public:
+  // Opens the archive at the given path and reads its central directory.
+  // Throws a ZipException if the file is not a readable ZIP archive.
+  explicit ZipArchive(const std::string& path);
+
+  ZipArchive(const ZipArchive&) = delete;
+  ZipArchive& operator=(const ZipArchive&) = delete;
+
+  // Returns true iff the file at path starts with a ZIP signature.
+  static bool isZipFile(const std::string& path);
+
+  // Returns true iff the archive contains a member with the given name. If
+  // no member matches the name exactly, members in sub-folders match by
+  // their file name.
+  bool has(const std::string& name) const;
+
+  // Returns a stream on the uncompressed content of the member with the
+  // given name (matched as in has()), or an empty pointer if there is no
+  // such member. The stream reads from the archive file independently of
+  // this object and may outlive it. Corrupt data is reported by throwing a
+  // ZipException from the stream's read functions.
+  std::unique_ptr<std::istream> open(const std::string& name) const;
+
+ private:
+  friend class ZipEntryBuf;
+
+  // The archive file, shared with the member streams.
+  struct File;
+
+  struct Entry {
+    uint16_t method;
+    uint32_t crc;
+    uint64_t compSize;
+    uint64_t size;
+    uint64_t localOffset;
+  };
+
+  std::string _path;
+  std::shared_ptr<File> _file;
+  std::unordered_map<std::string, Entry> _entries;
+
+  void readCentralDir();
+  const Entry* find(const std::string& name) const;
+};
+}  // namespace util
+}  // namespace ad
+
+#endif  // AD_UTIL_ZIPARCHIVE_H_
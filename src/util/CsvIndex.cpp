@@ -0,0 +1,237 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cppgtfs/util/CsvIndex.h"
+
+using ad::util::CsvIndex;
+using ad::util::CsvParser;
+using ad::util::CsvParserException;
+
+// first bytes of a sidecar file, the last one is the format version
+static const char MAGIC[8] = {'C', 'S', 'V', 'I', 'D', 'X', '\n', 1};
+
+// _____________________________________________________________________________
+static void put32(std::string* out, uint32_t v) {
+  for (size_t i = 0; i < 4; i++) {
+    out->push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+// _____________________________________________________________________________
+static void put64(std::string* out, uint64_t v) {
+  for (size_t i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+// _____________________________________________________________________________
+static void putStr(std::string* out, const std::string& s) {
+  put32(out, s.size());
+  out->append(s);
+}
+
+// Reads little-endian values from [*p, end), and sets *p to 0 if the input
+// is too short.
+// _____________________________________________________________________________
+static uint64_t take(const unsigned char** p, const unsigned char* end,
+                     size_t bytes) {
+  if (!*p || static_cast<size_t>(end - *p) < bytes) {
+    *p = 0;
+    return 0;
+  }
+  uint64_t v = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    v |= static_cast<uint64_t>((*p)[i]) << (8 * i);
+  }
+  *p += bytes;
+  return v;
+}
+
+// _____________________________________________________________________________
+static bool takeStr(const unsigned char** p, const unsigned char* end,
+                    std::string* s) {
+  uint64_t len = take(p, end, 4);
+  if (!*p || static_cast<uint64_t>(end - *p) < len) return false;
+  s->assign(reinterpret_cast<const char*>(*p), len);
+  *p += len;
+  return true;
+}
+
+// Appends the size and modification time of the file at path, which identify
+// the version of the file an index was built for.
+// _____________________________________________________________________________
+static bool putStamp(std::string* out, const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return false;
+  put64(out, st.st_size);
+  put64(out, st.st_mtim.tv_sec);
+  put64(out, st.st_mtim.tv_nsec);
+  return true;
+}
+
+// _____________________________________________________________________________
+CsvIndex::CsvIndex(CsvParser* csvp, const std::string& field) : _field(field) {
+  const char* base = 0;
+  const char* end = 0;
+  if (!csvp->getInput(&base, &end)) {
+    throw CsvParserException("cannot index input that is not memory-mapped",
+                             -1, field, 0);
+  }
+
+  size_t fld = csvp->getFieldIndex(field);
+
+  const char* pos = 0;
+  csvp->getRemaining(&pos, &end);
+
+  Ranges* cur = 0;
+  std::string curId;
+
+  while (csvp->readNextLine()) {
+    std::string_view id = csvp->getTStringView(fld);
+
+    if (!cur || id != curId) {
+      if (cur) cur->back().stop = pos - base;
+      curId = id;
+      cur = &_ranges[curId];
+      cur->push_back(Range{static_cast<uint64_t>(pos - base), 0,
+                           static_cast<uint64_t>(csvp->getCurLine())});
+    }
+
+    // the next record starts after the current one
+    csvp->getRemaining(&pos, &end);
+  }
+
+  if (cur) cur->back().stop = pos - base;
+}
+
+// _____________________________________________________________________________
+const CsvIndex::Ranges* CsvIndex::get(const std::string& key) const {
+  auto i = _ranges.find(key);
+  if (i == _ranges.end()) return 0;
+  return &i->second;
+}
+
+// _____________________________________________________________________________
+void CsvIndex::write(const std::string& path,
+                     const std::string& filePath) const {
+  std::string out(MAGIC, sizeof(MAGIC));
+  if (!putStamp(&out, filePath)) {
+    throw std::runtime_error("cannot stat " + filePath);
+  }
+  putStr(&out, _field);
+
+  put64(&out, _ranges.size());
+  for (const auto& r : _ranges) {
+    putStr(&out, r.first);
+    put64(&out, r.second.size());
+    for (const auto& range : r.second) {
+      put64(&out, range.begin);
+      put64(&out, range.stop);
+      put64(&out, range.line);
+    }
+  }
+
+  // write to a temporary file of our own first, so that readers never see
+  // a partially written index and concurrent writers do not interfere
+  std::string tmp = path + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  if (fd < 0) throw std::runtime_error("cannot write index " + path);
+
+  bool ok = fchmod(fd, 0644) == 0;
+  for (size_t off = 0; ok && off < out.size();) {
+    ssize_t n = ::write(fd, out.data() + off, out.size() - off);
+    if (n < 0 && errno == EINTR) continue;
+    ok = n > 0;
+    if (ok) off += n;
+  }
+  ok = close(fd) == 0 && ok;
+
+  if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+    remove(tmp.c_str());
+    throw std::runtime_error("cannot write index " + path);
+  }
+}
+
+// _____________________________________________________________________________
+bool CsvIndex::read(const std::string& path, const std::string& filePath,
+                    const std::string& field) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is) return false;
+  std::string in((std::istreambuf_iterator<char>(is)),
+                 std::istreambuf_iterator<char>());
+
+  std::string stamp;
+  if (!putStamp(&stamp, filePath)) return false;
+
+  if (in.size() < sizeof(MAGIC) + stamp.size() ||
+      memcmp(in.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+      memcmp(in.data() + sizeof(MAGIC), stamp.data(), stamp.size()) != 0) {
+    return false;
+  }
+
+  // the stamp starts with the size of the file
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(stamp.data());
+  uint64_t fileSize = take(&s, s + stamp.size(), 8);
+
+  const unsigned char* end =
+      reinterpret_cast<const unsigned char*>(in.data()) + in.size();
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(in.data()) +
+                           sizeof(MAGIC) + stamp.size();
+
+  std::string fld;
+  if (!takeStr(&p, end, &fld) || fld != field) return false;
+
+  // the counts are not trusted, each key takes at least 12 bytes and each
+  // range 24 bytes
+  std::unordered_map<std::string, Ranges> ranges;
+  uint64_t n = take(&p, end, 8);
+  if (!p || n > static_cast<uint64_t>(end - p) / 12) return false;
+  ranges.reserve(n);
+
+  for (uint64_t i = 0; i < n; i++) {
+    std::string key;
+    if (!takeStr(&p, end, &key)) return false;
+
+    // each key occurs once, with at least one range
+    Ranges& rs = ranges[key];
+    if (!rs.empty()) return false;
+    uint64_t m = take(&p, end, 8);
+    if (!p || m == 0 || m > static_cast<uint64_t>(end - p) / 24) {
+      return false;
+    }
+    rs.reserve(m);
+
+    for (uint64_t j = 0; j < m; j++) {
+      Range r;
+      r.begin = take(&p, end, 8);
+      r.stop = take(&p, end, 8);
+      r.line = take(&p, end, 8);
+      if (r.begin >= r.stop || r.stop > fileSize) return false;
+
+      // the ranges of a key follow each other in the file
+      if (!rs.empty() &&
+          (r.begin < rs.back().stop || r.line <= rs.back().line)) {
+        return false;
+      }
+      rs.push_back(r);
+    }
+  }
+
+  if (!p || p != end) return false;
+
+  _field = fld;
+  _ranges.swap(ranges);
+  return true;
+}
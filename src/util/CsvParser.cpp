@@ -4,13 +4,25 @@
 //          Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
 #include <cstring>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "cppgtfs/util/CsvParser.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(CPPGTFS_NO_SIMD)
+#define CPPGTFS_SIMD_X86
+#include <immintrin.h>
+#endif
+
 using ad::util::CsvParser;
 using std::remove;
 
@@ -19,128 +31,557 @@ static int pow10[10] = {1,      10,      100,      1000,      10000,
                         100000, 1000000, 10000000, 100000000, 1000000000};
 
 // _____________________________________________________________________________
-CsvParser::CsvParser() {}
+static inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+typedef void (*BlockScanner)(const char*, uint64_t*, uint64_t*);
+
+// _____________________________________________________________________________
+// Builds the bitmasks of the field ends (delimiters or newlines) and quote
+// ends (quotes or newlines) in the 64 bytes starting at p. Bit i is set iff
+// p[i] is such a character.
+static void scanBlockScalar(const char* p, uint64_t* fieldEnds,
+                            uint64_t* quoteEnds) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  // SWAR: compare 8 bytes at once, then gather the high bit of each byte
+  const uint64_t lo7 = 0x7F7F7F7F7F7F7F7FULL;
+  const uint64_t ones = 0x0101010101010101ULL;
+  uint64_t f = 0, q = 0;
+
+  for (size_t i = 0; i < 64; i += 8) {
+    uint64_t w;
+    memcpy(&w, p + i, 8);
+
+    uint64_t d = w ^ (ones * ',');
+    uint64_t n = w ^ (ones * '\n');
+    uint64_t c = w ^ (ones * '"');
+
+    // the high bit of each byte is set iff the byte is zero
+    d = ~(((d & lo7) + lo7) | d | lo7);
+    n = ~(((n & lo7) + lo7) | n | lo7);
+    c = ~(((c & lo7) + lo7) | c | lo7);
+
+    f |= ((((d | n) >> 7) * 0x0102040810204080ULL) >> 56) << i;
+    q |= ((((c | n) >> 7) * 0x0102040810204080ULL) >> 56) << i;
+  }
+#else
+  uint64_t f = 0, q = 0;
+  for (size_t i = 0; i < 64; i++) {
+    f |= static_cast<uint64_t>(p[i] == ',' || p[i] == '\n') << i;
+    q |= static_cast<uint64_t>(p[i] == '"' || p[i] == '\n') << i;
+  }
+#endif
+  *fieldEnds = f;
+  *quoteEnds = q;
+}
+
+#ifdef CPPGTFS_SIMD_X86
+// _____________________________________________________________________________
+__attribute__((target("sse2"))) static void scanBlockSse2(
+    const char* p, uint64_t* fieldEnds, uint64_t* quoteEnds) {
+  const __m128i d = _mm_set1_epi8(',');
+  const __m128i q = _mm_set1_epi8('"');
+  const __m128i n = _mm_set1_epi8('\n');
+  uint64_t f = 0, qe = 0;
+
+  for (size_t i = 0; i < 64; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i nl = _mm_cmpeq_epi8(v, n);
+    uint64_t fm = static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, d), nl)));
+    uint64_t qm = static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, q), nl)));
+    f |= fm << i;
+    qe |= qm << i;
+  }
+
+  *fieldEnds = f;
+  *quoteEnds = qe;
+}
+
+// _____________________________________________________________________________
+__attribute__((target("avx2"))) static void scanBlockAvx2(
+    const char* p, uint64_t* fieldEnds, uint64_t* quoteEnds) {
+  const __m256i d = _mm256_set1_epi8(',');
+  const __m256i q = _mm256_set1_epi8('"');
+  const __m256i n = _mm256_set1_epi8('\n');
+
+  __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+  __m256i nlLo = _mm256_cmpeq_epi8(lo, n);
+  __m256i nlHi = _mm256_cmpeq_epi8(hi, n);
+
+  uint64_t fLo = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(lo, d), nlLo)));
+  uint64_t fHi = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(hi, d), nlHi)));
+  uint64_t qLo = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(lo, q), nlLo)));
+  uint64_t qHi = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(hi, q), nlHi)));
+
+  *fieldEnds = fLo | (fHi << 32);
+  *quoteEnds = qLo | (qHi << 32);
+}
+#endif
+
+// _____________________________________________________________________________
+static BlockScanner selectBlockScanner() {
+#ifdef CPPGTFS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return &scanBlockAvx2;
+  if (__builtin_cpu_supports("sse2")) return &scanBlockSse2;
+#endif
+  return &scanBlockScalar;
+}
 
-CsvParser::CsvParser(std::istream* stream) : _curLine(0), _stream(stream) {
+// _____________________________________________________________________________
+static BlockScanner blockScanner() {
+  // chosen once for the running CPU
+  static const BlockScanner scanner = selectBlockScanner();
+  return scanner;
+}
+
+// size of the chunks read from non-mapped input
+static const size_t CHUNK_SIZE = 1 << 20;
+
+// _____________________________________________________________________________
+CsvParser::CsvParser()
+    : _curLine(0),
+      _linesRead(0),
+      _stream(0),
+      _fd(-1),
+      _map(0),
+      _mapSize(0),
+      _pos(0),
+      _end(0),
+      _eof(true),
+      _stop(0),
+      _open(false),
+      _blk(),
+      _scanBlock(blockScanner()),
+      _cStrValid(false) {}
+
+// _____________________________________________________________________________
+CsvParser::CsvParser(std::istream* stream)
+    : _curLine(0),
+      _linesRead(0),
+      _stream(stream),
+      _fd(-1),
+      _map(0),
+      _mapSize(0),
+      _pos(0),
+      _end(0),
+      _eof(false),
+      _stop(0),
+      _open(stream->good()),
+      _blk(),
+      _scanBlock(blockScanner()),
+      _cStrValid(false) {
   readNextLine();
   parseHeader();
 }
 
 // _____________________________________________________________________________
-bool CsvParser::readNextLine() {
-  if (!_stream->good()) return false;
+CsvParser::CsvParser(std::unique_ptr<std::istream> stream)
+    : _curLine(0),
+      _linesRead(0),
+      _stream(stream.get()),
+      _ownStream(std::move(stream)),
+      _fd(-1),
+      _map(0),
+      _mapSize(0),
+      _pos(0),
+      _end(0),
+      _eof(!_stream),
+      _stop(0),
+      _open(_stream && _stream->good()),
+      _blk(),
+      _scanBlock(blockScanner()),
+      _cStrValid(false) {
+  if (!_open) return;
 
-  // TODO: error message if buffer was too small
-  _stream->getline(_buff, 10000);
-  size_t readN = _stream->gcount();
-  _buff[readN] = 0;
+  readNextLine();
+  parseHeader();
+}
 
-  // Remove new line characters
-  while (_buff[readN - 1] == '\r' || _buff[readN - 1] == '\n') {
-    _buff[readN - 1] = 0;
-    readN--;
+// _____________________________________________________________________________
+CsvParser::CsvParser(const std::string& path)
+    : _curLine(0),
+      _linesRead(0),
+      _stream(0),
+      _fd(-1),
+      _map(0),
+      _mapSize(0),
+      _pos(0),
+      _end(0),
+      _eof(true),
+      _stop(0),
+      _open(false),
+      _blk(),
+      _scanBlock(blockScanner()),
+      _cStrValid(false) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return;
+
+  if (S_ISREG(st.st_mode) && mapFile(path)) {
+    _open = true;
+  } else if (!S_ISDIR(st.st_mode)) {
+    _fd = open(path.c_str(), O_RDONLY);
+    _open = _fd > -1;
+    _eof = !_open;
   }
 
-  _curLine++;
+  if (!_open) return;
 
-  if (readN == 0) return readNextLine();
-  size_t pos = 0;
-  size_t lastPos = pos;
-  bool firstChar = false;
-  bool esc = false;
-  int esc_quotes_found = 0;
-  _currentItems.clear();
-  _currentModItems.clear();
+  readNextLine();
+  parseHeader();
+}
+
+// _____________________________________________________________________________
+CsvParser::CsvParser(const char* begin, const char* stop, const char* end,
+                     const CsvParser& hdr)
+    : _curLine(hdr._curLine),
+      _linesRead(hdr._linesRead),
+      _stream(0),
+      _fd(-1),
+      _map(0),
+      _mapSize(0),
+      _pos(begin),
+      _end(end),
+      _eof(true),
+      _stop(stop),
+      _open(true),
+      _blk(),
+      _scanBlock(blockScanner()),
+      _headerMap(hdr._headerMap),
+      _headerVec(hdr._headerVec),
+      _cStrValid(false) {}
 
-  if (readN > 2 && static_cast<int>(_buff[0]) == -17 &&
-      static_cast<int>(_buff[1]) == -69 && static_cast<int>(_buff[2]) == -65) {
-    pos = 3;
-    lastPos = pos;
+// _____________________________________________________________________________
+CsvParser::~CsvParser() {
+  if (_map && _mapSize) munmap(const_cast<char*>(_map), _mapSize);
+  if (_fd > -1) close(_fd);
+}
+
+// _____________________________________________________________________________
+bool CsvParser::mapFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
   }
 
-  while (pos < readN) {
-    if (!firstChar && std::isspace(_buff[pos])) {
-      pos++;
-      lastPos = pos;
+  _mapSize = st.st_size;
+
+  if (_mapSize == 0) {
+    // empty files cannot be mapped, but are valid (empty) input
+    close(fd);
+    _map = _pos = _end = "";
+    return true;
+  }
+
+  void* m = mmap(0, _mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (m == MAP_FAILED) {
+    _mapSize = 0;
+    return false;
+  }
+
+  madvise(m, _mapSize, MADV_SEQUENTIAL);
+
+  _map = _pos = static_cast<const char*>(m);
+  _end = _map + _mapSize;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CsvParser::isOpen() const { return _open; }
+
+// _____________________________________________________________________________
+bool CsvParser::eof() const { return _eof && _pos == _end; }
+
+// _____________________________________________________________________________
+bool CsvParser::getRemaining(const char** begin, const char** end) const {
+  if (!_eof) return false;
+  *begin = _pos;
+  *end = _end;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CsvParser::getInput(const char** begin, const char** end) const {
+  if (!_map) return false;
+  *begin = _map;
+  *end = _map + _mapSize;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CsvParser::refill() {
+  if (_eof) return false;
+
+  // keep the unconsumed rest of the buffer, and grow the buffer if this rest
+  // already fills all of it (a record longer than the buffer)
+  size_t rest = _end - _pos;
+  if (_buf.empty()) {
+    _buf.resize(CHUNK_SIZE);
+  } else if (rest == _buf.size()) {
+    // the rest already starts at the front of the buffer
+    _buf.resize(_buf.size() * 2);
+  } else if (rest) {
+    memmove(_buf.data(), _pos, rest);
+  }
+
+  char* dst = _buf.data() + rest;
+  size_t space = _buf.size() - rest;
+  ssize_t n = 0;
+
+  if (_fd > -1) {
+    do {
+      n = read(_fd, dst, space);
+    } while (n < 0 && errno == EINTR);
+  } else if (_stream && _stream->good()) {
+    _stream->read(dst, space);
+    n = _stream->gcount();
+  }
+
+  if (n <= 0) {
+    n = 0;
+    _eof = true;
+  }
+
+  _pos = _buf.data();
+  _end = _buf.data() + rest + n;
+
+  // the buffer content changed, the cached block masks are stale
+  _blk.base = 0;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CsvParser::readNextLine() {
+  while (true) {
+    if (_stop && _pos >= _stop) return false;
+
+    // skip empty lines
+    const char* p = _pos;
+    while (p < _end && *p == '\r') p++;
+
+    if (p < _end && *p == '\n') {
+      _linesRead++;
+      _pos = p + 1;
       continue;
     }
 
-    if (_buff[pos] == '"' && !esc) {
-      esc = true;
-      pos++;
-      lastPos = pos;
-      continue;
+    if (p == _end) {
+      // only (possibly) carriage returns left in the buffer
+      if (refill()) continue;
+      _pos = _end;
+      return false;
     }
 
-    firstChar = true;
+    size_t lines = 0;
+    bool unterminated = false;
+    const char* recEnd = tokenize(_pos, _end, &lines, &unterminated);
 
-    if (!esc) {
-      const char* c = strchr(_buff + pos, ',');
-      if (c)
-        pos = c - _buff;
-      else
-        pos = readN - 1;
-    } else {
-      const char* c = strchr(_buff + pos, '"');
-      if (c)
-        pos = c - _buff;
-      else
-        pos = readN - 1;
-
-      if (pos < readN - 1 && _buff[pos + 1] == '"') {
-        pos += 2;
-        esc_quotes_found++;
-        continue;
-      } else {
-        // we end this field here, because of the closing quotes
-        // see CSV spec at http://tools.ietf.org/html/rfc4180#page-2
-        _buff[pos] = 0;
-        esc = false;
-        firstChar = false;
-
-        const char* c = strchr(_buff + pos + 1, ',');
-        if (c)
-          pos = c - _buff;
-        else
-          pos = readN - 1;
-      }
+    // the record may continue in the next chunk, tokenize it again after
+    // the buffer was refilled
+    if (recEnd == _end && refill()) continue;
+
+    if (unterminated) {
+      throw CsvParserException("unterminated quoted field", -1, "",
+                               _linesRead + 1);
     }
 
-    if (_buff[pos] == ',') {
-      _buff[pos] = 0;
-      firstChar = false;
+    _curLine = _linesRead + 1;
+    _linesRead += lines + 1;
+    _pos = recEnd == _end ? _end : recEnd + 1;
+    return true;
+  }
+}
+
+// _____________________________________________________________________________
+inline const char* CsvParser::findNext(const char* pos, const char* end,
+                                       uint64_t Block::*mask) {
+  while (pos < end) {
+    if (!_blk.base || pos < _blk.base || pos >= _blk.base + 64) {
+      loadBlock(pos, end);
     }
 
-    if (!esc_quotes_found) {
-      _currentItems.push_back(inlineRightTrim(_buff + lastPos));
-    } else {
-      size_t p = -1;
+    uint64_t m = (_blk.*mask) & (~uint64_t(0) << (pos - _blk.base));
+    if (m) return _blk.base + __builtin_ctzll(m);
 
-      // we have to modify to string (that is, we have to remove
-      // characters. create a copy of this item
-      // on the line-wise modified vector
-      _currentModItems.push_back(_buff + lastPos);
+    pos = _blk.base + 64;
+  }
+  return end;
+}
+
+// _____________________________________________________________________________
+void CsvParser::loadBlock(const char* pos, const char* end) {
+  _blk.base = pos;
+
+  if (end - pos >= 64) {
+    _scanBlock(pos, &_blk.fieldEnds, &_blk.quoteEnds);
+  } else {
+    // last, partial block: pad with zeros, which are never structural
+    char tmp[64] = {0};
+    memcpy(tmp, pos, end - pos);
+    _scanBlock(tmp, &_blk.fieldEnds, &_blk.quoteEnds);
+  }
+}
+
+// _____________________________________________________________________________
+const char* CsvParser::tokenize(const char* line, const char* end,
+                                size_t* lines, bool* unterminated) {
+  const char* pos = line;
+
+  _currentItems.clear();
+  _modBuf.clear();
+  _modItems.clear();
+  _cStrValid = false;
+
+  if (end - pos > 2 && static_cast<int>(line[0]) == -17 &&
+      static_cast<int>(line[1]) == -69 && static_cast<int>(line[2]) == -65) {
+    pos += 3;
+  }
+
+  while (pos < end) {
+    // skip leading whitespace
+    while (pos < end && *pos != '\n' && isSpace(*pos)) pos++;
+    if (pos == end || *pos == '\n') break;
+
+    if (*pos == '"') {
+      // quoted field, see CSV spec at http://tools.ietf.org/html/rfc4180#page-2
+      pos++;
+      while (pos < end && isSpace(*pos)) {
+        if (*pos == '\n') (*lines)++;
+        pos++;
+      }
+
+      const char* start = pos;
+      const char* fieldEnd = end;
+      bool escQuotesFound = false;
+
+      while (true) {
+        const char* c = findNext(pos, end, &Block::quoteEnds);
+        if (c == end) {
+          // the quote is not closed before end
+          *unterminated = true;
+          fieldEnd = pos = end;
+          break;
+        }
+
+        if (*c == '\n') {
+          // quoted fields may span multiple lines
+          (*lines)++;
+          pos = c + 1;
+          continue;
+        }
 
-      while (esc_quotes_found) {
-        p = _currentModItems.back().find("\"\"", p + 1);
-        if (p != std::string::npos) {
-          _currentModItems.back().replace(p, 2, "\"");
+        if (c + 1 < end && c[1] == '"') {
+          pos = c + 2;
+          escQuotesFound = true;
+          continue;
         }
 
-        esc_quotes_found--;
+        // we end this field here, because of the closing quotes
+        fieldEnd = c;
+        pos = c + 1;
+        break;
       }
 
-      // pointers will point to strings on the modified string vector
-      _currentItems.push_back(inlineRightTrim(_currentModItems.back().c_str()));
+      if (escQuotesFound) {
+        pushEscapedItem(start, fieldEnd - start);
+      } else {
+        pushItem(start, fieldEnd - start);
+      }
+
+      // ignore everything between the closing quote and the next delimiter
+      const char* c = findNext(pos, end, &Block::fieldEnds);
+      if (c == end || *c == '\n') {
+        pos = c;
+        break;
+      }
+      pos = c + 1;
+    } else {
+      const char* c = findNext(pos, end, &Block::fieldEnds);
+      pushItem(pos, c - pos);
+      if (c == end || *c == '\n') {
+        pos = c;
+        break;
+      }
+      pos = c + 1;
     }
+  }
 
-    lastPos = ++pos;
+  // the escaped items are final now, let their views point into the buffer
+  for (const auto& mi : _modItems) {
+    _currentItems[mi.first] = std::string_view(
+        _modBuf.data() + mi.second, _currentItems[mi.first].size());
   }
-  return true;
+
+  return pos;
+}
+
+// _____________________________________________________________________________
+inline void CsvParser::pushItem(const char* s, size_t len) {
+  while (len && isSpace(s[len - 1])) len--;
+  _currentItems.push_back(std::string_view(s, len));
+}
+
+// _____________________________________________________________________________
+void CsvParser::pushEscapedItem(const char* s, size_t len) {
+  size_t off = _modBuf.size();
+
+  for (size_t i = 0; i < len; i++) {
+    _modBuf.push_back(s[i]);
+    if (s[i] == '"' && i + 1 < len && s[i + 1] == '"') i++;
+  }
+
+  size_t modLen = _modBuf.size() - off;
+  while (modLen && isSpace(_modBuf[off + modLen - 1])) modLen--;
+
+  // the unescaped item is never longer than the original one, so we can
+  // temporarily let the view point to the original until _modBuf is final
+  _modItems.push_back({_currentItems.size(), off});
+  _currentItems.push_back(std::string_view(s, modLen));
+}
+
+// _____________________________________________________________________________
+void CsvParser::buildCStrings() const {
+  _cStrBuf.clear();
+  _cStrItems.clear();
+
+  std::vector<size_t> offsets;
+  offsets.reserve(_currentItems.size());
+
+  for (const auto& item : _currentItems) {
+    offsets.push_back(_cStrBuf.size());
+    _cStrBuf.append(item.data(), item.size());
+    _cStrBuf.push_back(0);
+  }
+
+  for (size_t off : offsets) _cStrItems.push_back(_cStrBuf.c_str() + off);
+  _cStrValid = true;
 }
 
 // _____________________________________________________________________________
 const char* CsvParser::getTString(const size_t i) const {
+  if (i >= _currentItems.size()) return "";
+  if (!_cStrValid) buildCStrings();
+  return _cStrItems[i];
+}
+
+// _____________________________________________________________________________
+std::string_view CsvParser::getTStringView(const size_t i) const {
+  if (i >= _currentItems.size()) return std::string_view();
   return _currentItems[i];
 }
 
@@ -151,10 +592,11 @@ double CsvParser::getDouble(const size_t i) const {
                              _curLine);
 
   bool fail = false;
-  double ret = atof(_currentItems[i], 38, &fail);
+  const auto& item = _currentItems[i];
+  double ret = atof(item.data(), item.data() + item.size(), 38, &fail);
   if (fail) {
     std::string a = "expected float number, found ";
-    a += _currentItems[i];
+    a += item;
     throw CsvParserException(a, i, getFieldName(i),
                              _curLine);
   }
@@ -167,7 +609,8 @@ int32_t CsvParser::getLong(const size_t i) const {
     throw CsvParserException("expected non-negative integer number", i,
                              getFieldName(i), _curLine);
   bool fail = false;
-  uint32_t ret = atoi(_currentItems[i], &fail);
+  const auto& item = _currentItems[i];
+  uint32_t ret = atoi(item.data(), item.data() + item.size(), &fail);
   if (fail)
     throw CsvParserException("expected non-negative integer number", i,
                              getFieldName(i), _curLine);
@@ -181,12 +624,12 @@ bool CsvParser::hasItem(const std::string& fieldName) const {
 
 // _____________________________________________________________________________
 bool CsvParser::fieldIsEmpty(const std::string& fieldName) const {
-  return strlen(getTString(fieldName)) == 0;
+  return getTStringView(fieldName).empty();
 }
 
 // _____________________________________________________________________________
 bool CsvParser::fieldIsEmpty(size_t field) const {
-  return strlen(getTString(field)) == 0;
+  return getTStringView(field).empty();
 }
 
 // _____________________________________________________________________________
@@ -194,6 +637,11 @@ const char* CsvParser::getTString(const std::string& fieldName) const {
   return getTString(getFieldIndex(fieldName));
 }
 
+// _____________________________________________________________________________
+std::string_view CsvParser::getTStringView(const std::string& fieldName) const {
+  return getTStringView(getFieldIndex(fieldName));
+}
+
 // _____________________________________________________________________________
 double CsvParser::getDouble(const std::string& fieldName) const {
   return getDouble(getFieldIndex(fieldName));
@@ -235,50 +683,43 @@ const string CsvParser::getFieldName(size_t i) const {
 void CsvParser::parseHeader() {
   _headerMap.clear();
   for (size_t i = 0; i < getNumColumns(); ++i) {
-    string s = getTString(i);
+    string s(getTStringView(i));
     s.erase(remove_if(s.begin(), s.end(), isspace), s.end());
     _headerMap[s] = i;
     _headerVec.push_back(s);
   }
 }
 
-// _____________________________________________________________________________
-const char* CsvParser::inlineRightTrim(const char* t) const {
-  char* s = const_cast<char*>(t);
-  char* end = s + std::strlen(s) - 1;
-  while (std::isspace(*end)) *end-- = 0;
-  return s;
-}
-
 // ___________________________________________________________________________
-inline uint32_t CsvParser::atoi(const char* p, bool* fail) {
+inline uint32_t CsvParser::atoi(const char* p, const char* end, bool* fail) {
   uint32_t x = 0;
-  while (*p >= '0' && *p <= '9') {
+  while (p < end && *p >= '0' && *p <= '9') {
     x = (x * 10) + (*p - '0');
     ++p;
   }
-  if (*p != 0 && *p != ' ') *fail = true;
+  if (p < end && *p != ' ') *fail = true;
   return x;
 }
 
 // ___________________________________________________________________________
-inline double CsvParser::atof(const char* p, uint8_t mn, bool* fail) {
+inline double CsvParser::atof(const char* p, const char* end, uint8_t mn,
+                             bool* fail) {
   // this atof implementation works only on "normal" float strings like
   // 56.445 or -345.00, but should be faster than std::atof
   double ret = 0.0;
   bool neg = false;
   bool decSep = false;
-  if (*p == '-') {
+  if (p < end && *p == '-') {
     neg = true;
     p++;
   }
 
-  while (*p >= '0' && *p <= '9') {
+  while (p < end && *p >= '0' && *p <= '9') {
     ret = ret * 10.0 + (*p - '0');
     p++;
   }
 
-  if (*p == '.') {
+  if (p < end && *p == '.') {
     if (decSep) {
       *fail = true;
       return 0;
@@ -288,7 +729,7 @@ inline double CsvParser::atof(const char* p, uint8_t mn, bool* fail) {
     double f = 0;
     uint8_t n = 0;
 
-    for (; n < mn && *p >= '0' && *p <= '9'; n++, p++) {
+    for (; n < mn && p < end && *p >= '0' && *p <= '9'; n++, p++) {
       f = f * 10.0 + (*p - '0');
     }
 
@@ -296,7 +737,7 @@ inline double CsvParser::atof(const char* p, uint8_t mn, bool* fail) {
       ret += f / pow10[n];
     else
       ret += f / std::pow(10, n);
-  } else if (*p != 0 && *p != ' ') {
+  } else if (p < end && *p != ' ') {
     *fail = true;
     return 0;
   }
@@ -0,0 +1,409 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "cppgtfs/util/ZipArchive.h"
+
+using ad::util::ZipArchive;
+using ad::util::ZipEntryBuf;
+using ad::util::ZipException;
+
+// signatures of the ZIP records
+static const uint32_t LOCAL_HEADER_SIG = 0x04034b50;
+static const uint32_t CENTRAL_HEADER_SIG = 0x02014b50;
+static const uint32_t END_OF_CD_SIG = 0x06054b50;
+static const uint32_t ZIP64_END_OF_CD_SIG = 0x06064b50;
+static const uint32_t ZIP64_LOCATOR_SIG = 0x07064b50;
+
+// size of the chunks of compressed data read from the archive
+static const size_t IN_CHUNK_SIZE = 1 << 16;
+
+// _____________________________________________________________________________
+static inline uint16_t rd16(const unsigned char* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+// _____________________________________________________________________________
+static inline uint32_t rd32(const unsigned char* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// _____________________________________________________________________________
+static inline uint64_t rd64(const unsigned char* p) {
+  return static_cast<uint64_t>(rd32(p)) |
+         (static_cast<uint64_t>(rd32(p + 4)) << 32);
+}
+
+struct ZipArchive::File {
+  explicit File(int fd) : fd(fd) {}
+  ~File() { close(fd); }
+
+  // Reads exactly n bytes at offset off into dst. Returns false on a short
+  // read or an error. Safe to call concurrently.
+  bool read(unsigned char* dst, size_t n, uint64_t off) const {
+    while (n) {
+      ssize_t r = pread(fd, dst, n, off);
+      if (r < 0 && errno == EINTR) continue;
+      if (r <= 0) return false;
+      dst += r;
+      n -= r;
+      off += r;
+    }
+    return true;
+  }
+
+  int fd;
+};
+
+namespace ad {
+namespace util {
+
+/**
+ * Stream buffer on the uncompressed content of a single archive member.
+ * Bulk reads (sgetn(), used by istream::read()) inflate directly into the
+ * caller's buffer.
+ */
+class ZipEntryBuf : public std::streambuf {
+ public:
+  ZipEntryBuf(std::shared_ptr<const ZipArchive::File> file,
+              const ZipArchive::Entry& e, uint64_t dataOffset,
+              const std::string& name)
+      : _file(file),
+        _entry(e),
+        _name(name),
+        _off(dataOffset),
+        _compLeft(e.compSize),
+        _produced(0),
+        _crc(crc32(0, Z_NULL, 0)),
+        _done(false) {
+    memset(&_zs, 0, sizeof(_zs));
+    if (_entry.method == 8) {
+      // raw deflate data, without zlib header
+      if (inflateInit2(&_zs, -MAX_WBITS) != Z_OK) {
+        throw ZipException("Could not initialize inflate for " + _name);
+      }
+      _in.resize(IN_CHUNK_SIZE);
+    }
+  }
+
+  ~ZipEntryBuf() {
+    if (_entry.method == 8) inflateEnd(&_zs);
+  }
+
+ protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    size_t n = produce(_out, sizeof(_out));
+    if (n == 0) return traits_type::eof();
+    setg(_out, _out, _out + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  std::streamsize xsgetn(char* s, std::streamsize n) override {
+    std::streamsize got = 0;
+
+    // first drain what is left in the get area
+    if (gptr() < egptr()) {
+      got = std::min<std::streamsize>(n, egptr() - gptr());
+      memcpy(s, gptr(), got);
+      gbump(got);
+    }
+
+    while (got < n) {
+      size_t r = produce(s + got, n - got);
+      if (r == 0) break;
+      got += r;
+    }
+
+    return got;
+  }
+
+ private:
+  std::shared_ptr<const ZipArchive::File> _file;
+  ZipArchive::Entry _entry;
+  std::string _name;
+
+  // offset of the next compressed byte in the archive, and the number of
+  // compressed bytes left
+  uint64_t _off;
+  uint64_t _compLeft;
+
+  uint64_t _produced;
+  uLong _crc;
+  bool _done;
+
+  z_stream _zs;
+  std::vector<unsigned char> _in;
+  char _out[1 << 12];
+
+  // Writes up to n uncompressed bytes to dst. Returns the number of bytes
+  // written, which is 0 only at the end of the member.
+  size_t produce(char* dst, size_t n) {
+    if (_done || n == 0) return 0;
+
+    size_t r = 0;
+    if (_entry.method == 0) {
+      r = std::min<uint64_t>(n, _compLeft);
+      if (r && !_file->read(reinterpret_cast<unsigned char*>(dst), r, _off)) {
+        throw ZipException("Could not read " + _name);
+      }
+      _off += r;
+      _compLeft -= r;
+    } else {
+      r = inflateTo(dst, n);
+    }
+
+    _crc = crc32(_crc, reinterpret_cast<const Bytef*>(dst), r);
+    _produced += r;
+
+    if (r == 0) {
+      _done = true;
+      if (_produced != _entry.size || _crc != _entry.crc) {
+        throw ZipException("Corrupt data (size or CRC mismatch) in " + _name);
+      }
+    }
+
+    return r;
+  }
+
+  // Inflates up to n bytes to dst, reading compressed data as needed.
+  size_t inflateTo(char* dst, size_t n) {
+    // zlib counts in uInt
+    n = std::min<size_t>(n, 1u << 30);
+
+    _zs.next_out = reinterpret_cast<Bytef*>(dst);
+    _zs.avail_out = n;
+
+    while (_zs.avail_out == n) {
+      if (_zs.avail_in == 0 && _compLeft) {
+        size_t c = std::min<uint64_t>(_in.size(), _compLeft);
+        if (!_file->read(_in.data(), c, _off)) {
+          throw ZipException("Could not read " + _name);
+        }
+        _off += c;
+        _compLeft -= c;
+        _zs.next_in = _in.data();
+        _zs.avail_in = c;
+      }
+
+      int ret = inflate(&_zs, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) break;
+      if (ret == Z_BUF_ERROR && _zs.avail_in == 0 && _compLeft == 0) {
+        throw ZipException("Unexpected end of compressed data in " + _name);
+      }
+      if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        throw ZipException("Corrupt compressed data in " + _name);
+      }
+    }
+
+    return n - _zs.avail_out;
+  }
+};
+
+/**
+ * Input stream owning its ZipEntryBuf.
+ */
+class ZipEntryStream : public std::istream {
+ public:
+  explicit ZipEntryStream(std::unique_ptr<ZipEntryBuf> buf)
+      : std::istream(buf.get()), _buf(std::move(buf)) {
+    // let read errors propagate to the caller instead of looking like EOF
+    exceptions(std::ios::badbit);
+  }
+
+ private:
+  std::unique_ptr<ZipEntryBuf> _buf;
+};
+}  // namespace util
+}  // namespace ad
+
+// _____________________________________________________________________________
+ZipArchive::ZipArchive(const std::string& path) : _path(path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw ZipException("Could not open " + path);
+  _file = std::make_shared<File>(fd);
+
+  readCentralDir();
+}
+
+// _____________________________________________________________________________
+bool ZipArchive::isZipFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  unsigned char sig[4];
+  bool ret = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+             pread(fd, sig, 4, 0) == 4 &&
+             (rd32(sig) == LOCAL_HEADER_SIG || rd32(sig) == END_OF_CD_SIG);
+  close(fd);
+  return ret;
+}
+
+// _____________________________________________________________________________
+void ZipArchive::readCentralDir() {
+  struct stat st;
+  if (fstat(_file->fd, &st) != 0) throw ZipException("Could not stat " + _path);
+  uint64_t fileSize = st.st_size;
+
+  // the end of central directory record is at the end of the file, followed
+  // only by a comment of at most 64 KiB
+  uint64_t tailSize = std::min<uint64_t>(fileSize, 22 + 0xFFFF);
+  std::vector<unsigned char> tail(tailSize);
+  if (!_file->read(tail.data(), tailSize, fileSize - tailSize)) {
+    throw ZipException("Could not read " + _path);
+  }
+
+  int64_t eocd = -1;
+  for (int64_t i = static_cast<int64_t>(tailSize) - 22; i >= 0; i--) {
+    if (rd32(&tail[i]) == END_OF_CD_SIG) {
+      eocd = i;
+      break;
+    }
+  }
+  if (eocd < 0) throw ZipException(_path + " is not a ZIP archive");
+
+  uint64_t numEntries = rd16(&tail[eocd + 10]);
+  uint64_t cdSize = rd32(&tail[eocd + 12]);
+  uint64_t cdOffset = rd32(&tail[eocd + 16]);
+
+  uint64_t eocdOffset = fileSize - tailSize + eocd;
+  if ((numEntries == 0xFFFF || cdSize == 0xFFFFFFFF ||
+       cdOffset == 0xFFFFFFFF) &&
+      eocdOffset >= 20) {
+    // ZIP64, the locator directly precedes the end of central directory
+    unsigned char loc[20];
+    unsigned char rec[56];
+    if (_file->read(loc, 20, eocdOffset - 20) &&
+        rd32(loc) == ZIP64_LOCATOR_SIG &&
+        _file->read(rec, 56, rd64(loc + 8)) &&
+        rd32(rec) == ZIP64_END_OF_CD_SIG) {
+      numEntries = rd64(rec + 32);
+      cdSize = rd64(rec + 40);
+      cdOffset = rd64(rec + 48);
+    }
+  }
+
+  if (cdOffset + cdSize > fileSize) {
+    throw ZipException("Corrupt central directory in " + _path);
+  }
+
+  std::vector<unsigned char> cd(cdSize);
+  if (!_file->read(cd.data(), cdSize, cdOffset)) {
+    throw ZipException("Could not read " + _path);
+  }
+
+  std::vector<std::pair<std::string, Entry>> entries;
+  size_t p = 0;
+
+  for (uint64_t i = 0; i < numEntries; i++) {
+    if (p + 46 > cd.size() || rd32(&cd[p]) != CENTRAL_HEADER_SIG) {
+      throw ZipException("Corrupt central directory in " + _path);
+    }
+
+    const unsigned char* h = &cd[p];
+    uint16_t flags = rd16(h + 8);
+    uint16_t nameLen = rd16(h + 28);
+    uint16_t extraLen = rd16(h + 30);
+    uint16_t commentLen = rd16(h + 32);
+
+    if (p + 46 + nameLen + extraLen + commentLen > cd.size()) {
+      throw ZipException("Corrupt central directory in " + _path);
+    }
+
+    Entry e;
+    e.method = rd16(h + 10);
+    e.crc = rd32(h + 16);
+    e.compSize = rd32(h + 20);
+    e.size = rd32(h + 24);
+    e.localOffset = rd32(h + 42);
+
+    // ZIP64 extended information, holding those values that did not fit
+    const unsigned char* x = h + 46 + nameLen;
+    const unsigned char* xEnd = x + extraLen;
+    while (x + 4 <= xEnd) {
+      uint16_t id = rd16(x);
+      uint16_t len = rd16(x + 2);
+      const unsigned char* v = x + 4;
+      const unsigned char* vEnd = std::min(v + len, xEnd);
+      if (id == 0x0001) {
+        if (e.size == 0xFFFFFFFF && v + 8 <= vEnd) {
+          e.size = rd64(v);
+          v += 8;
+        }
+        if (e.compSize == 0xFFFFFFFF && v + 8 <= vEnd) {
+          e.compSize = rd64(v);
+          v += 8;
+        }
+        if (e.localOffset == 0xFFFFFFFF && v + 8 <= vEnd) {
+          e.localOffset = rd64(v);
+          v += 8;
+        }
+      }
+      x = vEnd;
+    }
+
+    std::string name(reinterpret_cast<const char*>(h + 46), nameLen);
+    p += 46 + nameLen + extraLen + commentLen;
+
+    // skip folders and encrypted members
+    if (name.empty() || name.back() == '/' || (flags & 1)) continue;
+    entries.push_back({name, e});
+  }
+
+  for (const auto& e : entries) _entries[e.first] = e.second;
+
+  // members in sub-folders are also found by their file name, unless another
+  // member already has this name
+  for (const auto& e : entries) {
+    size_t slash = e.first.rfind('/');
+    if (slash == std::string::npos) continue;
+    if (e.first.compare(0, 9, "__MACOSX/") == 0) continue;
+    _entries.insert({e.first.substr(slash + 1), e.second});
+  }
+}
+
+// _____________________________________________________________________________
+const ZipArchive::Entry* ZipArchive::find(const std::string& name) const {
+  auto i = _entries.find(name);
+  if (i == _entries.end()) return 0;
+  return &i->second;
+}
+
+// _____________________________________________________________________________
+bool ZipArchive::has(const std::string& name) const { return find(name); }
+
+// _____________________________________________________________________________
+std::unique_ptr<std::istream> ZipArchive::open(const std::string& name) const {
+  const Entry* e = find(name);
+  if (!e) return std::unique_ptr<std::istream>();
+
+  if (e->method != 0 && e->method != 8) {
+    throw ZipException("Unsupported compression method " +
+                       std::to_string(e->method) + " for " + name + " in " +
+                       _path);
+  }
+
+  unsigned char lh[30];
+  if (!_file->read(lh, 30, e->localOffset) || rd32(lh) != LOCAL_HEADER_SIG) {
+    throw ZipException("Corrupt local header for " + name + " in " + _path);
+  }
+
+  // the local extra field may differ from the one in the central directory
+  uint64_t dataOffset = e->localOffset + 30 + rd16(lh + 26) + rd16(lh + 28);
+
+  std::unique_ptr<ZipEntryBuf> buf(
+      new ZipEntryBuf(_file, *e, dataOffset, _path + "/" + name));
+  return std::unique_ptr<std::istream>(new ZipEntryStream(std::move(buf)));
+}
@@ -453,8 +453,8 @@ namespace ad
         inline void dtoa_milo(double value, char *buffer)
         {
             // Not handling NaN and inf
-            assert(!isnan(value));
-            assert(!isinf(value));
+            assert(!std::isnan(value));
+            assert(!std::isinf(value));
 
             if (value == 0) {
                 buffer[0] = '0';
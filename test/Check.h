@@ -0,0 +1,69 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef CPPGTFS_TEST_CHECK_H_
+#define CPPGTFS_TEST_CHECK_H_
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Minimal checks for the tests, which are plain executables: CHECK() and
+// CHECK_EQ() report a failed condition and count it, and main() returns
+// checkResult(). Unlike assert(), they are also compiled with NDEBUG.
+
+namespace cppgtfs_test {
+
+inline int& failures() {
+  static int n = 0;
+  return n;
+}
+
+inline void fail(const char* file, int line, const std::string& msg) {
+  std::cerr << file << ":" << line << ": check failed: " << msg << std::endl;
+  failures()++;
+}
+
+inline int checkResult() {
+  if (failures()) std::cerr << failures() << " check(s) failed" << std::endl;
+  return failures() ? 1 : 0;
+}
+
+// Returns a new empty directory, removed by the caller if wanted.
+inline std::string tmpDir() {
+  char tpl[] = "/tmp/cppgtfs-test-XXXXXX";
+  const char* d = mkdtemp(tpl);
+  if (!d) {
+    std::cerr << "cannot create a temporary directory" << std::endl;
+    exit(1);
+  }
+  return d;
+}
+
+// Writes content to the file at path.
+inline void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream f(path, std::ios::binary);
+  f << content;
+}
+
+}  // namespace cppgtfs_test
+
+#define CHECK(c)                                             \
+  do {                                                       \
+    if (!(c)) cppgtfs_test::fail(__FILE__, __LINE__, #c);    \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                 \
+  do {                                                                 \
+    if (!((a) == (b))) {                                               \
+      std::ostringstream _msg;                                         \
+      _msg << #a << " == " << #b << " (" << (a) << " vs " << (b) << ")"; \
+      cppgtfs_test::fail(__FILE__, __LINE__, _msg.str());              \
+    }                                                                  \
+  } while (0)
+
+#endif  // CPPGTFS_TEST_CHECK_H_
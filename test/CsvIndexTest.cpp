@@ -0,0 +1,184 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <stdint.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/util/CsvIndex.h"
+
+using ad::util::CsvIndex;
+using ad::util::CsvParser;
+
+namespace {
+
+void put32(std::string* s, uint32_t v) {
+  for (size_t i = 0; i < 4; i++) s->push_back(static_cast<char>(v >> 8 * i));
+}
+
+void put64(std::string* s, uint64_t v) {
+  for (size_t i = 0; i < 8; i++) s->push_back(static_cast<char>(v >> 8 * i));
+}
+
+void putStr(std::string* s, const std::string& str) {
+  put32(s, str.size());
+  *s += str;
+}
+
+std::string readFile(const std::string& path) {
+  std::ifstream f(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(f),
+                     std::istreambuf_iterator<char>());
+}
+
+// A sidecar with the magic bytes and file stamp of the valid sidecar
+// valid, indexing field "k" with the given ranges by key.
+std::string sidecar(const std::string& valid,
+                    const std::vector<std::pair<std::string,
+                                                CsvIndex::Ranges>>& keys) {
+  std::string s = valid.substr(0, 8 + 24);
+  putStr(&s, "k");
+  put64(&s, keys.size());
+  for (const auto& k : keys) {
+    putStr(&s, k.first);
+    put64(&s, k.second.size());
+    for (const auto& r : k.second) {
+      put64(&s, r.begin);
+      put64(&s, r.stop);
+      put64(&s, r.line);
+    }
+  }
+  return s;
+}
+
+// Returns the values of field v of the records in the given ranges.
+std::vector<std::string> values(const std::string& path,
+                                const CsvIndex::Ranges& rs) {
+  std::vector<std::string> ret;
+  CsvParser hdr(path);
+  const char* b;
+  const char* e;
+  hdr.getInput(&b, &e);
+  for (const auto& r : rs) {
+    CsvParser p(b + r.begin, b + r.stop, e, hdr);
+    while (p.readNextLine()) {
+      ret.push_back(p.getTString(p.getFieldIndex("v")));
+      if (ret.size() == 1) CHECK_EQ(p.getCurLine(), 2);
+    }
+  }
+  return ret;
+}
+
+bool sameRanges(const CsvIndex& a, const CsvIndex& b) {
+  if (a.getRanges().size() != b.getRanges().size()) return false;
+  for (const auto& r : a.getRanges()) {
+    const CsvIndex::Ranges* o = b.get(r.first);
+    if (!o || o->size() != r.second.size()) return false;
+    for (size_t i = 0; i < o->size(); i++) {
+      if ((*o)[i].begin != r.second[i].begin ||
+          (*o)[i].stop != r.second[i].stop ||
+          (*o)[i].line != r.second[i].line) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::string dir = cppgtfs_test::tmpDir();
+  std::string path = dir + "/t.txt";
+  std::string idx = path + ".idx";
+
+  // key a comes in two runs, the second one after a multi-line record
+  cppgtfs_test::writeFile(path,
+                          "k,v\n"
+                          "a,1\n"
+                          "a,2\n"
+                          "b,\"3\n3\"\n"
+                          "a,4\n"
+                          "c,5");
+
+  CsvParser csvp(path);
+  CsvIndex index(&csvp, "k");
+  CHECK_EQ(index.getRanges().size(), size_t(3));
+  CHECK(!index.get("d"));
+  CHECK(values(path, *index.get("a")) ==
+        std::vector<std::string>({"1", "2", "4"}));
+  CHECK(values(path, *index.get("b")) == std::vector<std::string>({"3\n3"}));
+  CHECK(values(path, *index.get("c")) == std::vector<std::string>({"5"}));
+  CHECK_EQ((*index.get("a"))[1].line, uint64_t(6));
+
+  // round trip through a sidecar
+  index.write(idx, path);
+  {
+    CsvIndex read;
+    CHECK(read.read(idx, path, "k"));
+    CHECK(sameRanges(read, index));
+    CHECK(!read.read(idx, path, "v"));
+    CHECK(!read.read(dir + "/missing.idx", path, "k"));
+  }
+
+  std::string valid = readFile(idx);
+
+  // truncated at every length, or with trailing bytes
+  for (size_t len = 0; len < valid.size(); len++) {
+    cppgtfs_test::writeFile(idx, valid.substr(0, len));
+    CsvIndex read;
+    CHECK(!read.read(idx, path, "k"));
+  }
+  cppgtfs_test::writeFile(idx, valid + "x");
+  {
+    CsvIndex read;
+    CHECK(!read.read(idx, path, "k"));
+  }
+
+  // corrupt ranges
+  uint64_t size = readFile(path).size();
+  std::vector<std::vector<std::pair<std::string, CsvIndex::Ranges>>> bad = {
+      // a key without ranges
+      {{"a", {}}},
+      // an empty range
+      {{"a", {{4, 4, 2}}}},
+      // a range past the end of the file
+      {{"a", {{4, size + 1, 2}}}},
+      // overlapping ranges
+      {{"a", {{4, 12, 2}, {8, 20, 3}}}},
+      // ranges out of order
+      {{"a", {{19, 23, 6}, {4, 12, 2}}}},
+      // a key given twice
+      {{"a", {{4, 12, 2}}}, {"a", {{19, 23, 6}}}},
+  };
+  for (const auto& keys : bad) {
+    cppgtfs_test::writeFile(idx, sidecar(valid, keys));
+    CsvIndex read;
+    CHECK(!read.read(idx, path, "k"));
+  }
+
+  // the crafted sidecars are read if their ranges are valid
+  cppgtfs_test::writeFile(idx, sidecar(valid, {{"a", {{4, 12, 2}}}}));
+  {
+    CsvIndex read;
+    CHECK(read.read(idx, path, "k"));
+    CHECK(values(path, *read.get("a")) ==
+          std::vector<std::string>({"1", "2"}));
+  }
+
+  // a sidecar of a changed file is ignored
+  index.write(idx, path);
+  cppgtfs_test::writeFile(path, "k,v\na,1\n");
+  {
+    CsvIndex read;
+    CHECK(!read.read(idx, path, "k"));
+  }
+
+  cppgtfs_test::removeDir(dir);
+  return cppgtfs_test::checkResult();
+}
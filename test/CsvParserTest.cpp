@@ -0,0 +1,137 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "./Check.h"
+#include "cppgtfs/util/CsvParser.h"
+
+using ad::util::CsvParser;
+
+namespace {
+
+struct Row {
+  std::string a, b, c;
+  int32_t line;
+
+  bool operator==(const Row& o) const {
+    return a == o.a && b == o.b && c == o.c && line == o.line;
+  }
+};
+
+// Builds a table with plain, quoted, escaped, multi-line and empty fields,
+// CRLF line ends, a field longer than the parser's chunk size, and no
+// newline after the last record. Sets *rows to the expected records.
+std::string table(std::vector<Row>* rows) {
+  std::string csv = "a,b,c\n";
+  int32_t line = 2;
+  for (size_t i = 0; i < 5000; i++) {
+    std::string n = std::to_string(i);
+    Row r{"r" + n, "", "c" + n, line};
+    std::string b;
+    switch (i % 5) {
+      case 0:
+        b = "x" + n;
+        r.b = b;
+        break;
+      case 1:
+        b = "\"x," + n + "\"";
+        r.b = "x," + n;
+        break;
+      case 2:
+        b = "\"x\"\"" + n + "\"";
+        r.b = "x\"" + n;
+        break;
+      case 3:
+        b = "\"x\n" + n + "\"";
+        r.b = "x\n" + n;
+        line++;
+        break;
+      default:
+        break;
+    }
+    if (i == 2500) r.c = std::string(3 << 20, 'z');
+    csv += r.a + "," + b + "," + r.c;
+    if (i + 1 < 5000) csv += i % 7 ? "\n" : "\r\n";
+    line++;
+    rows->push_back(r);
+  }
+  return csv;
+}
+
+std::vector<Row> read(CsvParser* p) {
+  std::vector<Row> ret;
+  size_t a = p->getFieldIndex("a");
+  size_t b = p->getFieldIndex("b");
+  size_t c = p->getFieldIndex("c");
+  while (p->readNextLine()) {
+    ret.push_back(Row{p->getTString(a), p->getTString(b),
+                      std::string(p->getTStringView(c)), p->getCurLine()});
+  }
+  return ret;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::vector<Row> rows;
+  std::string csv = table(&rows);
+  std::string dir = cppgtfs_test::tmpDir();
+  std::string path = dir + "/t.txt";
+  cppgtfs_test::writeFile(path, csv);
+
+  // memory-mapped
+  {
+    CsvParser p(path);
+    CHECK(p.isOpen());
+    const char* b;
+    const char* e;
+    CHECK(p.getInput(&b, &e));
+    CHECK_EQ(static_cast<size_t>(e - b), csv.size());
+    CHECK(read(&p) == rows);
+    CHECK(p.eof());
+  }
+
+  // chunked from a stream
+  {
+    std::istringstream in(csv);
+    CsvParser p(&in);
+    const char* b;
+    const char* e;
+    CHECK(!p.getInput(&b, &e));
+    CHECK(read(&p) == rows);
+  }
+
+  // owned stream
+  {
+    CsvParser p(std::unique_ptr<std::istream>(new std::istringstream(csv)));
+    CHECK(read(&p) == rows);
+  }
+
+  // in-memory range after the header of another parser
+  {
+    CsvParser hdr(path);
+    const char* b;
+    const char* e;
+    CHECK(hdr.getRemaining(&b, &e));
+    CsvParser p(b, e, e, hdr);
+    CHECK(read(&p) == rows);
+  }
+
+  // a missing file and an empty stream
+  {
+    CsvParser p(dir + "/missing.txt");
+    CHECK(!p.isOpen());
+    CsvParser q{std::unique_ptr<std::istream>()};
+    CHECK(!q.isOpen());
+    CHECK(!q.readNextLine());
+  }
+
+  unlink(path.c_str());
+  rmdir(dir.c_str());
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,164 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef CPPGTFS_TEST_FEEDS_H_
+#define CPPGTFS_TEST_FEEDS_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "./Check.h"
+
+// Synthetic GTFS feeds for the tests, and a text form of parsed feeds to
+// compare them by.
+
+namespace cppgtfs_test {
+
+// The tables of a feed with the given number of trips, by file name. The
+// trips follow 20 stop sequences and start 2 minutes apart. Some stop
+// times have quoted headsigns, with commas, escaped quotes or a line
+// break. The stop times of each trip are given out of order.
+inline std::map<std::string, std::string> feedTables(size_t trips) {
+  std::map<std::string, std::string> t;
+  t["agency.txt"] =
+      "agency_id,agency_name,agency_url,agency_timezone\n"
+      "A1,Agency,http://a.example,Europe/Berlin\n";
+  t["calendar.txt"] =
+      "service_id,monday,tuesday,wednesday,thursday,friday,saturday,sunday,"
+      "start_date,end_date\n"
+      "WK,1,1,1,1,1,0,0,20240101,20241231\n";
+
+  std::string& stops = t["stops.txt"];
+  stops = "stop_id,stop_name,stop_lat,stop_lon\n";
+  for (size_t i = 0; i < 50; i++) {
+    std::ostringstream s;
+    s << "S" << i << ",Stop " << i << "," << 47.9 + i * 0.001 << ","
+      << 7.8 + i * 0.002 << "\n";
+    stops += s.str();
+  }
+
+  std::string& routes = t["routes.txt"];
+  routes = "route_id,agency_id,route_short_name,route_long_name,route_type\n";
+  for (size_t i = 0; i < 5; i++) {
+    routes += "R" + std::to_string(i) + ",A1," + std::to_string(i) +
+              ",Route " + std::to_string(i) + ",3\n";
+  }
+
+  std::string& shapes = t["shapes.txt"];
+  shapes =
+      "shape_id,shape_pt_lat,shape_pt_lon,shape_pt_sequence,"
+      "shape_dist_traveled\n";
+  for (size_t i = 0; i < 10; i++) {
+    for (size_t j = 0; j < 30; j++) {
+      std::ostringstream s;
+      s << "SH" << i << "," << 47.9 + j * 0.0005 << "," << 7.8 + i * 0.01
+        << "," << j + 1 << "," << j * 12.5 << "\n";
+      shapes += s.str();
+    }
+  }
+
+  std::string& ts = t["trips.txt"];
+  ts = "route_id,service_id,trip_id,shape_id\n";
+  std::string& sts = t["stop_times.txt"];
+  sts =
+      "trip_id,arrival_time,departure_time,stop_id,stop_sequence,"
+      "stop_headsign,pickup_type,drop_off_type,shape_dist_traveled\n";
+
+  for (size_t i = 0; i < trips; i++) {
+    std::string id = "T" + std::to_string(i);
+    ts += "R" + std::to_string(i % 5) + ",WK," + id + ",SH" +
+          std::to_string(i % 10) + "\n";
+
+    size_t pat = i % 20;
+    size_t n = 10 + pat % 7;
+    int start = 5 * 3600 + static_cast<int>(i) * 120;
+    std::vector<std::string> rows;
+    for (size_t j = 0; j < n; j++) {
+      int at = start + static_cast<int>(j) * 150 + static_cast<int>(pat);
+      int dt = at + (j % 3 ? 30 : 0);
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%02d:%02d:%02d,%02d:%02d:%02d", at / 3600,
+               (at / 60) % 60, at % 60, dt / 3600, (dt / 60) % 60, dt % 60);
+      std::string hs;
+      if (j % 4 == 1) hs = "\"To \"\"" + std::to_string(pat) + "\"\", via\"";
+      if (j % 4 == 3 && pat % 2) hs = "\"Line\nbreak\"";
+      rows.push_back(id + "," + buf + ",S" +
+                     std::to_string((pat * 3 + j * 7) % 50) + "," +
+                     std::to_string(j * 2 + 1) + "," + hs + "," +
+                     std::to_string(j % 2) + ",0," +
+                     std::to_string(j * 100) + "\n");
+    }
+    std::rotate(rows.begin(), rows.begin() + n / 2, rows.end());
+    for (const auto& r : rows) sts += r;
+  }
+  return t;
+}
+
+// Writes the tables of feedTables() into dir.
+inline void writeFeed(const std::string& dir, size_t trips) {
+  for (const auto& t : feedTables(trips)) {
+    writeFile(dir + "/" + t.first, t.second);
+  }
+}
+
+// Removes dir with the files written into it.
+inline void removeDir(const std::string& dir) {
+  std::string cmd = "rm -rf '" + dir + "'";
+  if (system(cmd.c_str()) != 0) std::cerr << "cannot remove " << dir << "\n";
+}
+
+// Returns the stop times of the given trip as text.
+template <typename TripT>
+std::string stopTimesText(const TripT& trip) {
+  std::ostringstream s;
+  for (const auto& st : trip.getStopTimes()) {
+    s << st.getStop()->getId() << "," << st.getArrivalTime().toString() << ","
+      << st.getDepartureTime().toString() << "," << st.getSeq() << ","
+      << st.getHeadsign() << "," << st.getPickupType() << ","
+      << st.getDropOffType() << "," << st.getShapeDistanceTravelled()
+      << "\n";
+  }
+  return s.str();
+}
+
+// Returns the stops, trips with their stop times, and shapes of feed as
+// text, sorted by id.
+template <typename FeedT>
+std::string feedText(const FeedT& feed) {
+  std::map<std::string, std::string> stops, trips, shapes;
+  for (const auto& s : feed.getStops()) {
+    std::ostringstream o;
+    o << s.second->getName() << "," << s.second->getLat() << ","
+      << s.second->getLng();
+    stops[s.second->getId()] = o.str();
+  }
+  for (const auto& t : feed.getTrips()) {
+    trips[t.second->getId()] = t.second->getRoute()->getId() + "," +
+                               t.second->getShape()->getId() + "\n" +
+                               stopTimesText(*t.second);
+  }
+  for (const auto& sh : feed.getShapes()) {
+    std::ostringstream o;
+    for (const auto& p : sh.second->getPoints()) {
+      o << p.seq << "," << p.lat << "," << p.lng << "," << p.travelDist
+        << "\n";
+    }
+    shapes[sh.second->getId()] = o.str();
+  }
+
+  std::string ret;
+  for (const auto& s : stops) ret += "stop " + s.first + "," + s.second + "\n";
+  for (const auto& t : trips) ret += "trip " + t.first + "," + t.second;
+  for (const auto& s : shapes) ret += "shape " + s.first + "\n" + s.second;
+  return ret;
+}
+
+}  // namespace cppgtfs_test
+
+#endif  // CPPGTFS_TEST_FEEDS_H_
@@ -0,0 +1,113 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+#include "cppgtfs/gtfs/FlatContainer.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::gtfs::Agency;
+using ad::cppgtfs::gtfs::Feed;
+using ad::cppgtfs::gtfs::FlatContainer;
+using ad::cppgtfs::gtfs::FlatFeed;
+
+namespace {
+
+Agency agency(const std::string& id) {
+  return Agency(id, "name " + id, "", "", "", "", "", "");
+}
+
+// Returns true if c holds exactly the agencies in ref, by id.
+bool same(const FlatContainer<Agency>& c,
+          const std::map<std::string, Agency*>& ref) {
+  if (c.size() != ref.size()) return false;
+  size_t n = 0;
+  for (const auto& kv : c) {
+    auto r = ref.find(std::string(kv.first));
+    if (r == ref.end() || r->second != kv.second) return false;
+    if (kv.second->getName() != "name " + r->first) return false;
+    n++;
+  }
+  if (n != ref.size()) return false;
+  for (const auto& r : ref) {
+    if (c.get(r.first) != r.second) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  // an empty container
+  {
+    FlatContainer<Agency> c;
+    CHECK(!c.get("a"));
+    CHECK(!c.has("a"));
+    CHECK(!c.remove("a"));
+    CHECK(c.begin() == c.end());
+    CHECK_EQ(c.size(), size_t(0));
+  }
+
+  // duplicates are rejected, ids are looked up as any string_view
+  {
+    FlatContainer<Agency> c;
+    Agency* a = c.add(agency("a"));
+    CHECK(a);
+    CHECK(!c.add(agency("a")));
+    CHECK_EQ(c.size(), size_t(1));
+    const char buf[] = "xay";
+    CHECK(c.get(std::string_view(buf + 1, 1)) == a);
+    CHECK(!c.has(std::string_view(buf, 2)));
+  }
+
+  // random adds and removes against a reference. With few distinct ids
+  // the table holds long probe runs, and removing from their middle has to
+  // shift back the entries behind the gap.
+  for (size_t ids : {20, 300, 5000}) {
+    FlatContainer<Agency> c;
+    std::map<std::string, Agency*> ref;
+    uint64_t rnd = 42;
+    for (size_t i = 0; i < 40000; i++) {
+      rnd = rnd * 6364136223846793005ull + 1442695040888963407ull;
+      std::string id = "A" + std::to_string((rnd >> 33) % ids);
+      bool rem = (rnd >> 20) % 5 < 2;
+      if (rem) {
+        CHECK_EQ(c.remove(id), ref.erase(id) == 1);
+      } else {
+        Agency* a = c.add(agency(id));
+        CHECK_EQ(a != 0, ref.count(id) == 0);
+        if (a) ref[id] = a;
+      }
+      if (i % 997 == 0) CHECK(same(c, ref));
+    }
+    CHECK(same(c, ref));
+
+    // remove all, in id order
+    for (const auto& r : ref) CHECK(c.remove(r.first));
+    CHECK_EQ(c.size(), size_t(0));
+    CHECK(c.begin() == c.end());
+  }
+
+  // a FlatFeed parses to the same as a Feed
+  {
+    std::string dir = cppgtfs_test::tmpDir();
+    cppgtfs_test::writeFeed(dir, 300);
+    Feed a;
+    FlatFeed b;
+    Parser p;
+    CHECK(p.parse(&a, dir));
+    CHECK(p.parse(&b, dir));
+    CHECK_EQ(b.getTrips().size(), size_t(300));
+    CHECK(cppgtfs_test::feedText(a) == cppgtfs_test::feedText(b));
+    cppgtfs_test::removeDir(dir);
+  }
+
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,113 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <sys/stat.h>
+#include <cstring>
+#include <string>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::ParserException;
+using ad::cppgtfs::gtfs::Feed;
+
+namespace {
+
+// nominal size of the byte ranges of stop_times.txt parsed by a thread
+const size_t CHUNK_SIZE = 1 << 22;
+
+// Returns stop_times.txt for trips T0... of feedTables(), with pad more
+// characters in each headsign. Every headsign is quoted and holds a line
+// break about in the middle of its record, so that a chunk border found
+// by the next line break lies inside a quoted field for about half of the
+// borders. If badLine is not 0, the
+// record starting on this line refers to a missing stop.
+std::string stopTimes(size_t trips, size_t pad, size_t badLine,
+                      size_t* quotedSeams, size_t* seams) {
+  std::string ret =
+      "trip_id,arrival_time,departure_time,stop_id,stop_sequence,"
+      "stop_headsign,pickup_type,drop_off_type,shape_dist_traveled\n";
+  size_t line = 2;
+  for (size_t i = 0; i < trips; i++) {
+    for (size_t j = 0; j < 25; j++) {
+      int at = 5 * 3600 + static_cast<int>(i * 60 + j * 90);
+      char t[32];
+      snprintf(t, sizeof(t), "%02d:%02d:%02d", at / 3600, (at / 60) % 60,
+               at % 60);
+      std::string stop = line == badLine ? "NOPE" : "S" + std::to_string(j);
+      ret += "T" + std::to_string(i) + "," + t + "," + t + "," + stop + "," +
+             std::to_string(j + 1) + ",\"Hs " + std::to_string(i) + "\n" +
+             std::to_string(j) + std::string(40 + pad, ' ') + "\",0,0," +
+             std::to_string(j * 10) + "\n";
+      line += 2;
+    }
+  }
+
+  // classify the chunk borders
+  size_t hdr = ret.find('\n') + 1;
+  *quotedSeams = *seams = 0;
+  for (size_t nom = hdr + CHUNK_SIZE; nom < ret.size(); nom += CHUNK_SIZE) {
+    const char* nl = strchr(ret.c_str() + nom, '\n');
+    if (!nl) break;
+    (*seams)++;
+    size_t pos = nl - ret.c_str();
+    size_t q = std::count(ret.begin() + hdr, ret.begin() + pos, '"');
+    if (q % 2) (*quotedSeams)++;
+    nom = pos + 1;
+  }
+  return ret;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::string dir = cppgtfs_test::tmpDir();
+  cppgtfs_test::writeFeed(dir, 6000);
+
+  size_t quoted = 0, seams = 0;
+  for (size_t pad : {0, 7, 23}) {
+    size_t q, s;
+    cppgtfs_test::writeFile(dir + "/stop_times.txt",
+                            stopTimes(6000, pad, 0, &q, &s));
+    quoted += q;
+    seams += s;
+
+    Feed serial;
+    Parser(false, 1).parse(&serial, dir);
+    std::string expected = cppgtfs_test::feedText(serial);
+    CHECK(expected.find("Hs 5999\n24,") != std::string::npos);
+
+    for (size_t threads : {2, 4, 16}) {
+      Feed par;
+      Parser(false, threads).parse(&par, dir);
+      CHECK(cppgtfs_test::feedText(par) == expected);
+    }
+  }
+
+  // the borders tested include ones inside and outside of quoted fields
+  CHECK(seams > quoted);
+  CHECK(quoted > 0);
+
+  // an error is reported on the same line as in serial mode
+  for (size_t badLine : {2, 200000, 300000}) {
+    size_t q, s;
+    cppgtfs_test::writeFile(dir + "/stop_times.txt",
+                            stopTimes(6000, 0, badLine, &q, &s));
+    for (size_t threads : {1, 4}) {
+      int64_t line = -1;
+      try {
+        Feed f;
+        Parser(false, threads).parse(&f, dir);
+      } catch (const ParserException& e) {
+        line = e.getLine();
+      }
+      CHECK_EQ(line, static_cast<int64_t>(badLine));
+    }
+  }
+
+  cppgtfs_test::removeDir(dir);
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,203 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <stdint.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "./Check.h"
+#include "cppgtfs/gtfs/Shape.h"
+
+using ad::cppgtfs::gtfs::Shape;
+using ad::cppgtfs::gtfs::ShapePoint;
+using ad::cppgtfs::gtfs::ShapePoints;
+using ad::cppgtfs::gtfs::ShapePolyline;
+
+namespace {
+
+uint64_t rnd = 7;
+
+uint32_t next() {
+  rnd = rnd * 6364136223846793005ull + 1442695040888963407ull;
+  return static_cast<uint32_t>(rnd >> 32);
+}
+
+float fromBits(uint32_t b) {
+  float f;
+  std::memcpy(&f, &b, sizeof(f));
+  return f;
+}
+
+bool sameFloat(float a, float b) { return std::memcmp(&a, &b, 4) == 0; }
+
+// Returns true if a and b hold the same points, bit by bit.
+bool same(const ShapePoints& a, const ShapePoints& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!sameFloat(a[i].lat, b[i].lat) || !sameFloat(a[i].lng, b[i].lng) ||
+        !sameFloat(a[i].travelDist, b[i].travelDist) ||
+        a[i].seq != b[i].seq) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Encodes pts and checks that they are given back exactly.
+void roundTrip(const ShapePoints& pts) {
+  ShapePolyline l;
+  for (const auto& p : pts) l.push_back(p);
+  CHECK_EQ(l.size(), pts.size());
+  CHECK_EQ(l.empty(), pts.empty());
+  if (!pts.empty()) CHECK_EQ(l.back().seq, pts.back().seq);
+  CHECK(same(l.decode(), pts));
+
+  ShapePolyline::Reader r(l);
+  ShapePoint p;
+  ShapePoints read;
+  while (r.next(&p)) read.push_back(p);
+  CHECK(same(read, pts));
+}
+
+// Returns a smooth shape of n points, rounded to the given decimal digits,
+// with sequence numbers first, first + step, ...
+ShapePoints smooth(size_t n, int digits, uint32_t first, uint32_t step) {
+  ShapePoints ret;
+  double f = std::pow(10, digits);
+  for (size_t i = 0; i < n; i++) {
+    double lat = 47.99 + i * 0.000137 + (next() % 100) * 1e-7;
+    double lng = 7.84 - i * 0.000091;
+    ret.push_back(ShapePoint(std::round(lat * f) / f, std::round(lng * f) / f,
+                             std::round(i * 13.7 * 10) / 10,
+                             first + i * step));
+  }
+  return ret;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  roundTrip({});
+  roundTrip({ShapePoint(47.5, 7.5, 0, 0)});
+  roundTrip({ShapePoint(47.5, 7.5, -1, 3)});
+
+  // constant steps, also starting at 0 and from large sequence numbers
+  roundTrip(smooth(500, 5, 1, 1));
+  roundTrip(smooth(500, 6, 0, 10));
+  roundTrip(smooth(500, 7, 4000000000u, 1));
+  roundTrip(smooth(2, 6, 5, 100));
+
+  // irregular steps, and a constant step broken after some points
+  {
+    ShapePoints pts = smooth(300, 6, 1, 1);
+    uint32_t seq = 0;
+    for (auto& p : pts) p.seq = seq += 1 + next() % 1000;
+    roundTrip(pts);
+
+    pts = smooth(300, 6, 1, 2);
+    for (size_t i = 150; i < pts.size(); i++) pts[i].seq += 1;
+    roundTrip(pts);
+    pts.back().seq += 10;
+    roundTrip(pts);
+  }
+
+  // more digits needed after some points
+  {
+    ShapePoints pts = smooth(100, 2, 1, 1);
+    ShapePoints more = smooth(100, 9, 101, 1);
+    pts.insert(pts.end(), more.begin(), more.end());
+    roundTrip(pts);
+  }
+
+  // values not given back by fixed-point numbers are stored as floats
+  {
+    const float inf = std::numeric_limits<float>::infinity();
+    ShapePoints pts = {ShapePoint(-0.0f, 0.0f, -0.0f, 1),
+                       ShapePoint(47.5f, 7.5f, 0, 2),
+                       ShapePoint(inf, -inf, 1e30f, 3),
+                       ShapePoint(std::nanf(""), 7.5f, 3e-39f, 4),
+                       ShapePoint(47.5f, 7.5f, -1, 5),
+                       ShapePoint(1e-9f, 1.0f / 3, 2e9f, 6),
+                       ShapePoint(-90, 180, 16777217, 7)};
+    roundTrip(pts);
+
+    // random bits, NaNs with payloads among them
+    pts.clear();
+    for (size_t i = 0; i < 2000; i++) {
+      pts.push_back(ShapePoint(fromBits(next()), fromBits(next()),
+                               fromBits(next()), i + 1));
+    }
+    roundTrip(pts);
+
+    // floats close to the coordinates of a shape, but not decimal
+    pts = smooth(300, 6, 1, 1);
+    for (size_t i = 0; i < pts.size(); i += 3) {
+      pts[i].lat = std::nextafter(pts[i].lat, 100.0f);
+    }
+    roundTrip(pts);
+  }
+
+  {
+    ShapePolyline l;
+    l.push_back(ShapePoint(1, 2, 3, 4));
+    l.clear();
+    CHECK(l.empty());
+    CHECK(l.decode().empty());
+  }
+
+  // points added in order
+  {
+    Shape s("s");
+    ShapePoints pts = smooth(50, 6, 1, 1);
+    for (const auto& p : pts) CHECK(s.addPoint(p));
+    CHECK(!s.addPoint(pts.back()));
+    CHECK(s.sortPoints());
+    CHECK(same(s.getPoints(), pts));
+    CHECK(same(s.getPolyline().decode(), pts));
+    CHECK_EQ(s.getNumPoints(), size_t(50));
+  }
+
+  // points added out of order wait for sortPoints()
+  {
+    Shape s("s");
+    ShapePoints pts = smooth(50, 6, 1, 3);
+    for (size_t i = 0; i < pts.size(); i++) {
+      CHECK(s.addPoint(pts[(i * 7) % pts.size()]));
+    }
+    CHECK_EQ(s.getNumPoints(), size_t(50));
+    CHECK(same(s.getPoints(), pts));
+    CHECK(s.sortPoints());
+    CHECK(same(s.getPolyline().decode(), pts));
+
+    // appended in order after the sorted points
+    ShapePoints more = smooth(10, 6, 1000, 1);
+    CHECK(s.appendPoints(more));
+    pts.insert(pts.end(), more.begin(), more.end());
+    CHECK(same(s.getPoints(), pts));
+  }
+
+  // a collision is found by sortPoints(), the points stay pending
+  {
+    Shape s("s");
+    ShapePoints pts = smooth(20, 6, 1, 1);
+    CHECK(s.appendPoints(ShapePoints(pts.begin() + 10, pts.end())));
+    CHECK(!s.appendPoints(ShapePoints(pts.begin(), pts.begin() + 11)));
+    CHECK(!s.sortPoints());
+    CHECK_EQ(s.getNumPoints(), size_t(21));
+    CHECK(!s.sortPoints());
+  }
+
+  // lazily loaded points
+  {
+    Shape s("s");
+    ShapePoints pts = smooth(80, 6, 1, 1);
+    s.setPointLoader([pts](ShapePoints* out) { *out = pts; });
+    CHECK(same(s.getPoints(), pts));
+    CHECK_EQ(s.getNumPoints(), size_t(80));
+  }
+
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,181 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+#include "cppgtfs/gtfs/StopTimeColumns.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::gtfs::CompactFeed;
+using ad::cppgtfs::gtfs::CompactStopTime;
+using ad::cppgtfs::gtfs::DenseFeed;
+using ad::cppgtfs::gtfs::DenseStopTime;
+using ad::cppgtfs::gtfs::Feed;
+using ad::cppgtfs::gtfs::Route;
+using ad::cppgtfs::gtfs::Service;
+using ad::cppgtfs::gtfs::Shape;
+using ad::cppgtfs::gtfs::Stop;
+using ad::cppgtfs::gtfs::StopTime;
+using ad::cppgtfs::gtfs::StopTimeColumns;
+using ad::cppgtfs::gtfs::Time;
+using ad::cppgtfs::gtfs::Trip;
+using ad::cppgtfs::gtfs::TripB;
+
+namespace {
+
+std::string stopKey(const Stop* s) { return s->getId(); }
+std::string stopKey(uint32_t i) { return "#" + std::to_string(i); }
+
+template <typename StopTimesT>
+std::string text(const StopTimesT& sts) {
+  std::ostringstream s;
+  for (const auto& st : sts) {
+    s << stopKey(st.getStopRef()) << "," << st.getArrivalTime().toString()
+      << "," << st.getDepartureTime().toString() << "," << st.getSeq() << ","
+      << st.getHeadsign() << "," << st.getPickupType() << ","
+      << st.getDropOffType() << "," << st.getShapeDistanceTravelled() << ","
+      << st.isTimepoint() << "\n";
+  }
+  return s.str();
+}
+
+// the trips of a feed, whose container holds either pointers or values
+template <typename TripT>
+TripT* trip(TripT& t) {
+  return &t;
+}
+template <typename TripT, typename K>
+TripT* trip(const std::pair<K, TripT*>& t) {
+  return t.second;
+}
+
+template <typename FeedT, typename TripT>
+std::vector<TripT*> trips(FeedT* feed) {
+  std::vector<TripT*> ret;
+  for (auto& t : feed->getTrips()) ret.push_back(trip<TripT>(t));
+  return ret;
+}
+
+// Checks the columns of the feed in dir, with the stop times of type
+// StopTimeT, against the stop times of the parsed trips.
+template <typename FeedT, typename StopTimeT>
+void check(const std::string& dir) {
+  typedef TripB<StopTimeT, Service, Route, Shape> TripT;
+  typedef StopTimeColumns<TripT, Stop> ColsT;
+
+  FeedT feed;
+  Parser().parse(&feed, dir);
+  std::vector<TripT*> ts = trips<FeedT, TripT>(&feed);
+  CHECK_EQ(ts.size(), size_t(300));
+
+  std::map<std::string, std::string> want;
+  size_t rows = 0;
+  ColsT cols;
+  for (auto t : ts) {
+    want[t->getId()] = text(t->getStopTimes());
+    rows += t->getStopTimes().size();
+    cols.add(t, false);
+  }
+  CHECK_EQ(cols.size(), rows);
+  CHECK(cols.getTrips() == ts);
+  for (auto t : ts) CHECK(text(cols.getStopTimes(t)) == want[t->getId()]);
+
+  // the empty headsign and the distinct ones of feedTables()
+  CHECK_EQ(cols.getHeadsigns().size(), size_t(22));
+
+  bool threw = false;
+  try {
+    cols.add(ts[5], false);
+  } catch (const std::runtime_error& e) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  // remove every third trip, the others keep their rows
+  std::unordered_set<const TripT*> rem;
+  std::vector<TripT*> kept;
+  for (size_t i = 0; i < ts.size(); i++) {
+    if (i % 3 == 1) {
+      rem.insert(ts[i]);
+      rows -= ts[i]->getStopTimes().size();
+    } else {
+      kept.push_back(ts[i]);
+    }
+  }
+  cols.remove(rem);
+  cols.remove({});
+  cols.shrink();
+  CHECK_EQ(cols.size(), rows);
+  CHECK(cols.getTrips() == kept);
+  for (auto t : ts) {
+    CHECK_EQ(cols.has(t), !rem.count(t));
+    if (rem.count(t)) {
+      CHECK(cols.getStopTimes(t).empty());
+    } else {
+      CHECK(text(cols.getStopTimes(t)) == want[t->getId()]);
+    }
+  }
+
+  // a removed trip can be added again
+  cols.add(ts[1], true);
+  CHECK(ts[1]->getStopTimes().empty());
+  CHECK(text(cols.getStopTimes(ts[1])) == want[ts[1]->getId()]);
+
+  // the stop times parsed directly into columns
+  FeedT feed2;
+  ColsT cols2;
+  Parser().parse(&feed2, dir, &cols2);
+  CHECK_EQ(cols2.getTrips().size(), size_t(300));
+  for (auto t : trips<FeedT, TripT>(&feed2)) {
+    CHECK(t->getStopTimes().empty());
+    CHECK(text(cols2.getStopTimes(t)) == want[t->getId()]);
+  }
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::string dir = cppgtfs_test::tmpDir();
+  cppgtfs_test::writeFeed(dir, 300);
+
+  check<Feed, StopTime<Stop>>(dir);
+  check<CompactFeed, CompactStopTime<Stop>>(dir);
+  check<DenseFeed, DenseStopTime<Stop>>(dir);
+
+  // empty times, times past midnight and the flags
+  {
+    Stop s("S", "", "", "", 0, 0, "", "",
+           ad::cppgtfs::gtfs::flat::Stop::STOP, 0, "",
+           ad::cppgtfs::gtfs::flat::Stop::NO_INFORMATION, "");
+    typedef StopTime<Stop>::PU_DO_TYPE P;
+    Trip t;
+    t.addStopTime(StopTime<Stop>(Time(0, 0, 0), Time(0, 0, 0), &s, 1, "",
+                                 P::REGULAR, P::NEVER, 0, true));
+    t.addStopTime(StopTime<Stop>(Time(), Time(), &s, 2, "x", P::NEVER,
+                                 P::MUST_PHONE_AGENCY, -1, false));
+    t.addStopTime(StopTime<Stop>(Time(25, 59, 59), Time(26, 0, 1), &s, 7,
+                                 "x", P::MUST_COORDINATE_W_DRIVER,
+                                 P::REGULAR, 12.5, true));
+
+    StopTimeColumns<Trip, Stop> cols;
+    cols.add(&t, false);
+    CHECK_EQ(cols.getArrivalTimes()[1],
+             (StopTimeColumns<Trip, Stop>::NO_TIME));
+    CHECK_EQ(cols.getArrivalTimes()[0], 0);
+    CHECK_EQ(cols.getHeadsigns().size(), size_t(2));
+    CHECK(cols.isTimepoint(0) && !cols.isTimepoint(1));
+    CHECK(text(cols.getStopTimes(&t)) == text(t.getStopTimes()));
+  }
+
+  cppgtfs_test::removeDir(dir);
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,106 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+// The block scanners are internal to CsvParser.cpp, which is included here
+// to test them directly. This test defines all of CsvParser itself and
+// thus does not use the library's copy of it.
+#include "../src/util/CsvParser.cpp"
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include "./Check.h"
+
+namespace {
+
+// The block masks, byte by byte.
+void scanBlockReference(const char* p, uint64_t* fieldEnds,
+                        uint64_t* quoteEnds) {
+  uint64_t f = 0, q = 0;
+  for (size_t i = 0; i < 64; i++) {
+    f |= static_cast<uint64_t>(p[i] == ',' || p[i] == '\n') << i;
+    q |= static_cast<uint64_t>(p[i] == '"' || p[i] == '\n') << i;
+  }
+  *fieldEnds = f;
+  *quoteEnds = q;
+}
+
+// Checks scan against the reference on blk.
+void check(BlockScanner scan, const char* name, const char* blk) {
+  uint64_t f, q, rf, rq;
+  scan(blk, &f, &q);
+  scanBlockReference(blk, &rf, &rq);
+  if (f != rf || q != rq) {
+    cppgtfs_test::fail(__FILE__, __LINE__,
+                       std::string(name) + " differs from the reference on " +
+                           std::string(blk, 64));
+  }
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::vector<std::pair<BlockScanner, const char*>> scanners = {
+      {&scanBlockScalar, "scalar"}};
+#ifdef CPPGTFS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    scanners.push_back({&scanBlockSse2, "sse2"});
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    scanners.push_back({&scanBlockAvx2, "avx2"});
+  }
+#endif
+
+  // the scanner chosen for the CPU is one of these
+  bool known = false;
+  for (const auto& s : scanners) known |= s.first == blockScanner();
+  CHECK(known);
+
+  // unaligned blocks
+  std::vector<char> buf(64 + 16);
+
+  // the special characters at every position, alone and as the only other
+  // character, and bytes differing from them only in the high bit
+  const char special[] = {',', '"', '\n', '\r', static_cast<char>(',' | 0x80),
+                          static_cast<char>('"' | 0x80),
+                          static_cast<char>('\n' | 0x80), 0};
+  for (size_t off = 0; off < 16; off++) {
+    char* blk = buf.data() + off;
+    for (char c : special) {
+      for (size_t i = 0; i < 64; i++) {
+        std::fill(blk, blk + 64, 'a');
+        blk[i] = c;
+        for (const auto& s : scanners) check(s.first, s.second, blk);
+
+        std::fill(blk, blk + 64, c);
+        blk[i] = 'a';
+        for (const auto& s : scanners) check(s.first, s.second, blk);
+      }
+    }
+  }
+
+  // random blocks, mostly of the special characters
+  std::mt19937 rng(42);
+  for (size_t n = 0; n < 200000; n++) {
+    char* blk = buf.data() + n % 16;
+    for (size_t i = 0; i < 64; i++) {
+      uint32_t r = rng();
+      blk[i] = r % 4 ? special[(r >> 8) % 7] : static_cast<char>(r >> 16);
+    }
+    for (const auto& s : scanners) check(s.first, s.second, blk);
+  }
+
+  // every byte value at every position
+  for (size_t v = 0; v < 256; v++) {
+    for (size_t i = 0; i < 64; i++) {
+      std::fill(buf.begin(), buf.end(), 'a');
+      buf[i] = static_cast<char>(v);
+      for (const auto& s : scanners) check(s.first, s.second, buf.data());
+    }
+  }
+
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,192 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+#include "cppgtfs/gtfs/TripPatterns.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::gtfs::CompactFeed;
+using ad::cppgtfs::gtfs::CompactStopTime;
+using ad::cppgtfs::gtfs::DenseFeed;
+using ad::cppgtfs::gtfs::DenseStopTime;
+using ad::cppgtfs::gtfs::Feed;
+using ad::cppgtfs::gtfs::Route;
+using ad::cppgtfs::gtfs::Service;
+using ad::cppgtfs::gtfs::Shape;
+using ad::cppgtfs::gtfs::Stop;
+using ad::cppgtfs::gtfs::StopTime;
+using ad::cppgtfs::gtfs::Time;
+using ad::cppgtfs::gtfs::Trip;
+using ad::cppgtfs::gtfs::TripB;
+using ad::cppgtfs::gtfs::TripPatterns;
+
+namespace {
+
+std::string stopKey(const Stop* s) { return s->getId(); }
+std::string stopKey(uint32_t i) { return "#" + std::to_string(i); }
+
+template <typename StopTimesT>
+std::string text(const StopTimesT& sts) {
+  std::ostringstream s;
+  for (const auto& st : sts) {
+    s << stopKey(st.getStopRef()) << "," << st.getArrivalTime().toString()
+      << "," << st.getDepartureTime().toString() << "," << st.getSeq() << ","
+      << st.getHeadsign() << "," << st.getPickupType() << ","
+      << st.getDropOffType() << "," << st.getShapeDistanceTravelled() << ","
+      << st.isTimepoint() << "\n";
+  }
+  return s.str();
+}
+
+// the trips of a feed, whose container holds either pointers or values
+template <typename TripT>
+TripT* trip(TripT& t) {
+  return &t;
+}
+template <typename TripT, typename K>
+TripT* trip(const std::pair<K, TripT*>& t) {
+  return t.second;
+}
+
+template <typename FeedT, typename TripT>
+std::vector<TripT*> trips(FeedT* feed) {
+  std::vector<TripT*> ret;
+  for (auto& t : feed->getTrips()) ret.push_back(trip<TripT>(t));
+  return ret;
+}
+
+// Checks the patterns of the feed in dir, with the stop times of type
+// StopTimeT, against the stop times of the parsed trips.
+template <typename FeedT, typename StopTimeT>
+void check(const std::string& dir) {
+  typedef TripB<StopTimeT, Service, Route, Shape> TripT;
+  typedef TripPatterns<TripT, Stop> PatternsT;
+
+  FeedT feed;
+  Parser().parse(&feed, dir);
+  std::vector<TripT*> ts = trips<FeedT, TripT>(&feed);
+  CHECK_EQ(ts.size(), size_t(300));
+
+  std::map<const TripT*, std::string> want;
+  for (auto t : ts) want[t] = text(t->getStopTimes());
+
+  // the trips of feedTables() follow 20 stop sequences, and only differ in
+  // their start within each
+  PatternsT pats;
+  for (size_t i = 0; i < ts.size(); i++) pats.add(ts[i], i % 2);
+  CHECK_EQ(pats.size(), size_t(20));
+  for (const auto& p : pats.getPatterns()) {
+    CHECK_EQ(p.getTrips().size(), size_t(15));
+    CHECK_EQ(p.getNumProfiles(), size_t(1));
+  }
+
+  bool threw = false;
+  try {
+    pats.add(ts[0], false);
+  } catch (const std::runtime_error& e) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  for (size_t i = 0; i < ts.size(); i++) {
+    size_t pos;
+    const typename PatternsT::Pattern* p = pats.getPattern(ts[i], &pos);
+    CHECK(p && p->getTrips()[pos] == ts[i]);
+    typename TripT::StopTimes sts;
+    for (size_t j = 0; j < p->getStops().size(); j++) {
+      sts.push_back(p->getStopTime(pos, j));
+    }
+    CHECK(text(sts) == want[ts[i]]);
+
+    // the released stop times are rebuilt from the pattern
+    CHECK(text(ts[i]->getStopTimes()) == want[ts[i]]);
+  }
+
+  TripT other;
+  CHECK(!pats.getPattern(&other, 0));
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::string dir = cppgtfs_test::tmpDir();
+  cppgtfs_test::writeFeed(dir, 300);
+
+  check<Feed, StopTime<Stop>>(dir);
+  check<CompactFeed, CompactStopTime<Stop>>(dir);
+  check<DenseFeed, DenseStopTime<Stop>>(dir);
+
+  cppgtfs_test::removeDir(dir);
+
+  // profiles, empty times and times before the start of a trip
+  {
+    typedef TripPatterns<Trip, Stop> PatternsT;
+    typedef StopTime<Stop>::PU_DO_TYPE P;
+    auto stop = [](const std::string& id) {
+      return Stop(id, "", "", "", 0, 0, "", "",
+                  ad::cppgtfs::gtfs::flat::Stop::STOP, 0, "",
+                  ad::cppgtfs::gtfs::flat::Stop::NO_INFORMATION, "");
+    };
+    Stop a = stop("A"), b = stop("B");
+
+    auto st = [&](Stop* s, uint32_t seq, Time at, Time dt) {
+      return StopTime<Stop>(at, dt, s, seq, "hs", P::REGULAR, P::REGULAR, -1,
+                            true);
+    };
+
+    std::vector<Trip> ts(8);
+    // the same profile from different starts
+    for (size_t i = 0; i < 2; i++) {
+      ts[i].addStopTime(st(&a, 1, Time(8 + i, 0, 0), Time(8 + i, 0, 30)));
+      ts[i].addStopTime(st(&b, 2, Time(8 + i, 5, 0), Time(8 + i, 5, 0)));
+    }
+    // another profile, an empty first time
+    ts[2].addStopTime(st(&a, 1, Time(), Time()));
+    ts[2].addStopTime(st(&b, 2, Time(9, 5, 0), Time(9, 5, 0)));
+    // a time 1 s before the start, and one at midnight
+    ts[3].addStopTime(st(&a, 1, Time(9, 0, 0), Time(9, 0, 0)));
+    ts[3].addStopTime(st(&b, 2, Time(8, 59, 59), Time(8, 59, 59)));
+    ts[4].addStopTime(st(&a, 1, Time(0, 0, 0), Time(0, 0, 1)));
+    ts[4].addStopTime(st(&b, 2, Time(), Time()));
+    // only empty times
+    ts[5].addStopTime(st(&a, 1, Time(), Time()));
+    ts[5].addStopTime(st(&b, 2, Time(), Time()));
+    // no stop times, twice
+    std::map<const Trip*, std::string> want;
+    for (const auto& t : ts) want[&t] = text(t.getStopTimes());
+
+    PatternsT pats;
+    for (auto& t : ts) pats.add(&t, true);
+    CHECK_EQ(pats.size(), size_t(2));
+
+    size_t pos0, pos1, pos3;
+    const PatternsT::Pattern* p = pats.getPattern(&ts[0], &pos0);
+    CHECK(p == pats.getPattern(&ts[1], &pos1));
+    CHECK(p == pats.getPattern(&ts[3], &pos3));
+    CHECK_EQ(p->getTrips().size(), size_t(6));
+    CHECK_EQ(p->getNumProfiles(), size_t(5));
+    CHECK_EQ(p->getProfile(pos0), p->getProfile(pos1));
+    CHECK_EQ(p->getStart(pos1), 9 * 3600);
+    CHECK_EQ(p->getArrival(pos3, 1), 9 * 3600 - 1);
+
+    size_t pos6;
+    const PatternsT::Pattern* e = pats.getPattern(&ts[6], &pos6);
+    CHECK(e && e == pats.getPattern(&ts[7], 0));
+    CHECK(e->getStops().empty());
+    CHECK_EQ(e->getNumProfiles(), size_t(0));
+
+    for (const auto& t : ts) CHECK(text(t.getStopTimes()) == want[&t]);
+    CHECK(!want[&ts[5]].empty());
+  }
+
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,116 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <string>
+#include <vector>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::ParserException;
+using ad::cppgtfs::gtfs::Feed;
+using ad::cppgtfs::gtfs::Stop;
+using ad::cppgtfs::gtfs::StopTime;
+using ad::cppgtfs::gtfs::Time;
+using ad::cppgtfs::gtfs::Trip;
+
+namespace {
+
+StopTime<Stop> st(Stop* s, uint32_t seq) {
+  return StopTime<Stop>(Time(8, 0, seq % 60), Time(8, 0, seq % 60), s, seq,
+                        "", StopTime<Stop>::PU_DO_TYPE::REGULAR,
+                        StopTime<Stop>::PU_DO_TYPE::REGULAR, -1, true);
+}
+
+std::vector<uint32_t> seqs(const Trip& t) {
+  std::vector<uint32_t> ret;
+  for (const auto& s : t.getStopTimes()) ret.push_back(s.getSeq());
+  return ret;
+}
+
+// Returns the line of the ParserException thrown when parsing the feed in
+// dir, or -2 if none is thrown.
+int64_t errorLine(const std::string& dir) {
+  try {
+    Feed f;
+    Parser().parse(&f, dir);
+  } catch (const ParserException& e) {
+    return e.getLine();
+  }
+  return -2;
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  Stop s("S", "", "", "", 0, 0, "", "", ad::cppgtfs::gtfs::flat::Stop::STOP,
+         0, "", ad::cppgtfs::gtfs::flat::Stop::NO_INFORMATION, "");
+
+  // bulk loading
+  {
+    Trip t;
+    CHECK(t.appendStopTime(st(&s, 1)));
+    CHECK(t.appendStopTime(st(&s, 5)));
+    CHECK(!t.appendStopTime(st(&s, 3)));
+    CHECK(!t.appendStopTime(st(&s, 2)));
+    CHECK(t.appendStopTime(st(&s, 9)));
+    CHECK(t.sortStopTimes());
+    CHECK(seqs(t) == std::vector<uint32_t>({1, 2, 3, 5, 9}));
+    CHECK(t.sortStopTimes());
+
+    CHECK(!t.appendStopTime(st(&s, 3)));
+    CHECK(!t.sortStopTimes());
+  }
+
+  // single inserts keep the stop times sorted and reject collisions
+  {
+    Trip t;
+    CHECK(t.addStopTime(st(&s, 4)));
+    CHECK(t.addStopTime(st(&s, 2)));
+    CHECK(t.addStopTime(st(&s, 8)));
+    CHECK(!t.addStopTime(st(&s, 2)));
+    CHECK(t.addStopTime(st(&s, 6)));
+    CHECK(seqs(t) == std::vector<uint32_t>({2, 4, 6, 8}));
+  }
+
+  std::string dir = cppgtfs_test::tmpDir();
+
+  // the stop times of each trip come out of order in the feed
+  {
+    cppgtfs_test::writeFeed(dir, 200);
+    Feed f;
+    Parser().parse(&f, dir);
+    for (const auto& t : f.getTrips()) {
+      std::vector<uint32_t> want;
+      size_t n = 10 + std::stoi(t.second->getId().substr(1)) % 20 % 7;
+      for (size_t j = 0; j < n; j++) want.push_back(j * 2 + 1);
+      CHECK(seqs(*t.second) == want);
+    }
+  }
+
+  // a collision with the record before is reported on its line, others
+  // once all stop times were read
+  {
+    const std::string hdr =
+        "trip_id,arrival_time,departure_time,stop_id,stop_sequence\n";
+    cppgtfs_test::writeFile(dir + "/stop_times.txt",
+                            hdr +
+                                "T1,08:00:00,08:00:00,S1,2\n"
+                                "T1,08:01:00,08:01:00,S2,1\n"
+                                "T1,08:02:00,08:02:00,S3,1\n");
+    CHECK_EQ(errorLine(dir), 4);
+
+    cppgtfs_test::writeFile(dir + "/stop_times.txt",
+                            hdr +
+                                "T1,08:00:00,08:00:00,S1,2\n"
+                                "T1,08:01:00,08:01:00,S2,1\n"
+                                "T1,08:02:00,08:02:00,S3,2\n");
+    CHECK_EQ(errorLine(dir), -1);
+  }
+
+  cppgtfs_test::removeDir(dir);
+  return cppgtfs_test::checkResult();
+}
@@ -0,0 +1,206 @@
+// Copyright 2016, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <stdint.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./Check.h"
+#include "./Feeds.h"
+#include "cppgtfs/Parser.h"
+#include "cppgtfs/util/ZipArchive.h"
+
+using ad::cppgtfs::Parser;
+using ad::cppgtfs::gtfs::Feed;
+using ad::util::ZipArchive;
+using ad::util::ZipException;
+
+namespace {
+
+struct Member {
+  std::string name;
+  std::string data;
+  bool deflate;
+  // if set, the CRC stored for the member is wrong
+  bool badCrc;
+};
+
+void put16(std::string* s, uint16_t v) {
+  for (size_t i = 0; i < 2; i++) s->push_back(static_cast<char>(v >> 8 * i));
+}
+
+void put32(std::string* s, uint32_t v) {
+  for (size_t i = 0; i < 4; i++) s->push_back(static_cast<char>(v >> 8 * i));
+}
+
+std::string rawDeflate(const std::string& in) {
+  z_stream z = z_stream();
+  deflateInit2(&z, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&z, in.size()), 0);
+  z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  z.avail_in = in.size();
+  z.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+// Returns a ZIP archive of the given members.
+std::string zip(const std::vector<Member>& members) {
+  std::string out, cd;
+  for (const auto& m : members) {
+    std::string comp = m.deflate ? rawDeflate(m.data) : m.data;
+    uint32_t crc = crc32(0, reinterpret_cast<const Bytef*>(m.data.data()),
+                         m.data.size());
+    if (m.badCrc) crc ^= 1;
+    uint32_t off = out.size();
+
+    put32(&out, 0x04034b50);
+    put16(&out, 20);
+    put16(&out, 0);
+    put16(&out, m.deflate ? 8 : 0);
+    put32(&out, 0);
+    put32(&out, crc);
+    put32(&out, comp.size());
+    put32(&out, m.data.size());
+    put16(&out, m.name.size());
+    put16(&out, 0);
+    out += m.name + comp;
+
+    put32(&cd, 0x02014b50);
+    put16(&cd, 20);
+    put16(&cd, 20);
+    put16(&cd, 0);
+    put16(&cd, m.deflate ? 8 : 0);
+    put32(&cd, 0);
+    put32(&cd, crc);
+    put32(&cd, comp.size());
+    put32(&cd, m.data.size());
+    put16(&cd, m.name.size());
+    put16(&cd, 0);
+    put16(&cd, 0);
+    put16(&cd, 0);
+    put16(&cd, 0);
+    put32(&cd, 0);
+    put32(&cd, off);
+    cd += m.name;
+  }
+
+  uint32_t cdOff = out.size();
+  out += cd;
+  put32(&out, 0x06054b50);
+  put16(&out, 0);
+  put16(&out, 0);
+  put16(&out, members.size());
+  put16(&out, members.size());
+  put32(&out, cd.size());
+  put32(&out, cdOff);
+  put16(&out, 0);
+  return out;
+}
+
+std::string readAll(std::istream* in) {
+  return std::string(std::istreambuf_iterator<char>(*in),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+// ____________________________________________________________________________
+int main() {
+  std::string dir = cppgtfs_test::tmpDir();
+
+  std::string big;
+  for (size_t i = 0; i < 200000; i++) big += std::to_string(i * 7919) + "\n";
+
+  std::vector<Member> members = {{"sub/big.txt", big, true, false},
+                                 {"stored.txt", "stored content", false, false},
+                                 {"empty.txt", "", true, false},
+                                 {"bad.txt", big, true, true}};
+  std::string path = dir + "/a.zip";
+  cppgtfs_test::writeFile(path, zip(members));
+  cppgtfs_test::writeFile(dir + "/plain.txt", "a,b\n1,2\n");
+
+  CHECK(ZipArchive::isZipFile(path));
+  CHECK(!ZipArchive::isZipFile(dir + "/plain.txt"));
+  CHECK(!ZipArchive::isZipFile(dir + "/missing.zip"));
+
+  {
+    std::unique_ptr<std::istream> s;
+    {
+      ZipArchive a(path);
+      CHECK(a.has("sub/big.txt"));
+      CHECK(a.has("big.txt"));
+      CHECK(a.has("stored.txt"));
+      CHECK(!a.has("missing.txt"));
+      CHECK(!a.open("missing.txt"));
+
+      auto stored = a.open("stored.txt");
+      CHECK(stored && readAll(stored.get()) == "stored content");
+      auto empty = a.open("empty.txt");
+      CHECK(empty && readAll(empty.get()).empty());
+
+      bool threw = false;
+      try {
+        readAll(a.open("bad.txt").get());
+      } catch (const ZipException& e) {
+        threw = true;
+      }
+      CHECK(threw);
+
+      s = a.open("big.txt");
+    }
+    // the stream outlives the archive
+    CHECK(s && readAll(s.get()) == big);
+  }
+
+  // not a ZIP archive, and a truncated one
+  {
+    bool threw = false;
+    try {
+      ZipArchive a(dir + "/plain.txt");
+    } catch (const ZipException& e) {
+      threw = true;
+    }
+    CHECK(threw);
+
+    std::string z = zip(members);
+    cppgtfs_test::writeFile(dir + "/trunc.zip", z.substr(0, z.size() - 30));
+    threw = false;
+    try {
+      ZipArchive a(dir + "/trunc.zip");
+    } catch (const ZipException& e) {
+      threw = true;
+    }
+    CHECK(threw);
+  }
+
+  // a feed parsed from a ZIP archive is the same as parsed from a folder
+  {
+    std::vector<Member> feed;
+    for (const auto& t : cppgtfs_test::feedTables(500)) {
+      feed.push_back({"gtfs/" + t.first, t.second, t.first != "agency.txt",
+                      false});
+    }
+    cppgtfs_test::writeFile(dir + "/feed.zip", zip(feed));
+    std::string fdir = dir + "/feed";
+    mkdir(fdir.c_str(), 0755);
+    cppgtfs_test::writeFeed(fdir, 500);
+
+    Feed a, b;
+    Parser p;
+    CHECK(p.parse(&a, dir + "/feed.zip"));
+    CHECK(p.parse(&b, fdir));
+    CHECK_EQ(a.getTrips().size(), size_t(500));
+    CHECK(cppgtfs_test::feedText(a) == cppgtfs_test::feedText(b));
+  }
+
+  cppgtfs_test::removeDir(dir);
+  return cppgtfs_test::checkResult();
+}